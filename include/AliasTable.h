@@ -0,0 +1,20 @@
+#ifndef ALIASTABLE_H
+#define ALIASTABLE_H
+
+#include <vector>
+#include <random>
+
+// Walker/Vose alias table: O(1) sampling from a fixed discrete distribution
+class AliasTable{
+    public:
+        AliasTable();
+        AliasTable(const std::vector<double> &weights);
+
+        int sample(std::mt19937 &gen);
+        int size();
+
+    private:
+        std::vector<double> prob;   // probability of keeping column i
+        std::vector<int> alias;     // fallback outcome for column i
+};
+#endif
@@ -0,0 +1,38 @@
+#ifndef APPOINTMENTLOG_H
+#define APPOINTMENTLOG_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "arrow/io/file.h"
+#include "parquet/api/writer.h"
+#include "MemoryTracker.h"
+
+// Visit-level event stream (SetupSchema_Appointments): patient id, epoch,
+// modality and AttendanceOutcome of every booked appointment. Events are
+// buffered column-wise and written as one row group per batch, so patients
+// only carry counters (first_appt, n_appts) while the history lives here.
+class AppointmentLog{
+    public:
+        AppointmentLog(std::string path, int batch_size = 1 << 20);
+        ~AppointmentLog();
+
+        void add(int patient_id, int epoch, int modality, int outcome);
+        void close();
+
+        long get_n_events();
+
+    private:
+        std::shared_ptr<arrow::io::FileOutputStream> outfile;
+        std::unique_ptr<parquet::ParquetFileWriter> writer;
+        int batch_size;
+        long n_events = 0;
+        tracked_vector<int32_t, memory_tracker::APPOINTMENTS> patient_ids;
+        tracked_vector<int32_t, memory_tracker::APPOINTMENTS> epochs;
+        tracked_vector<int32_t, memory_tracker::APPOINTMENTS> modalities;
+        tracked_vector<int32_t, memory_tracker::APPOINTMENTS> outcomes;
+
+        void flush();
+};
+#endif
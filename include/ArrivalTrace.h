@@ -0,0 +1,50 @@
+#ifndef ARRIVALTRACE_H
+#define ARRIVALTRACE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "arrow/io/file.h"
+#include "parquet/api/reader.h"
+#include "WaitlistEntry.h"
+
+// Historical referral trace replayed in place of the Poisson arrivals.
+// Columns are found by name: epoch (INT32), pathway (INT32), age (FLOAT or
+// DOUBLE, years) and optionally base_duration (INT32, defaults to the
+// pathway's); any others are ignored. Rows must be sorted by epoch. The file
+// is memory-mapped and read one row at a time, so only the current row is held
+// in memory whatever the trace length.
+class ArrivalTrace{
+    public:
+        ArrivalTrace(std::string path, std::vector<int> pathways);
+
+        // appends the rows for `epoch` to batch and returns how many there were
+        int read_epoch(int epoch, std::vector<WaitlistEntry> &batch);
+        bool exhausted();
+        long get_n_rows();
+
+    private:
+        std::string path;
+        std::vector<int> pathways;
+        std::unique_ptr<parquet::ParquetFileReader> file;
+        int epoch_idx = -1;
+        int pathway_idx = -1;
+        int age_idx = -1;
+        int duration_idx = -1;  // -1 without a base_duration column
+        bool double_age = false;
+        int row_group = -1;
+        std::shared_ptr<parquet::ColumnReader> epoch_col, pathway_col, age_col, duration_col;
+        bool has_pending = false;
+        WaitlistEntry pending;  // next row, not yet due
+        long n_rows = 0;
+
+        int find_column(std::string name, bool required, parquet::Type::type type,
+                        parquet::Type::type alt_type);
+        bool next_row_group();
+        template <typename Reader, typename Value>
+        void read_value(parquet::ColumnReader *col, const char *name, Value &value);
+        void read_row();
+};
+#endif
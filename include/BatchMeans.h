@@ -0,0 +1,59 @@
+#ifndef BATCHMEANS_H
+#define BATCHMEANS_H
+
+#include <vector>
+#include <string>
+
+// one batch-means interval; pathway is -1 for run-level metrics
+struct BatchMeansEstimate{
+    std::string metric;
+    int pathway;
+    double mean;
+    double lower;
+    double upper;
+    int n_batches;
+    int batch_size;     // epochs per batch
+    double lag1;        // lag-1 autocorrelation of the batch means
+    bool correlated;    // lag1 still significant at the final batch size
+};
+
+// Steady-state confidence intervals from a single long run. Every metric is a
+// ratio (sum / count) accumulated into consecutive batches of batch_size
+// epochs after the warm-up. At most 2 * n_batches batches are held: once they
+// fill up, adjacent pairs are merged and batch_size doubles, so memory does
+// not grow with run length. At the end the batch size keeps doubling while
+// the lag-1 autocorrelation of any metric's batch means is significant at
+// alpha and at least min_batches batches would remain.
+class BatchMeans{
+    public:
+        BatchMeans();
+        BatchMeans(int n_pathways, int warmup, int n_batches, int min_batches, double alpha);
+
+        // discharge stream, by discharge epoch
+        void add_discharge(int pathway, int epoch, int wait, int sojourn, bool age_out);
+        // once per epoch: occupied caseload slots, idle-or-not group servers, waitlist length
+        void add_epoch(int epoch, int busy_slots, int slots, int busy_groups, int n_groups, int waitlist_len);
+
+        std::vector<BatchMeansEstimate> estimates(double confidence);
+        int get_batch_size();
+
+        static void write_csv(std::string path, const std::vector<BatchMeansEstimate> &estimates);
+
+    private:
+        int n_pathways = 0;
+        int warmup = 0;
+        int n_batches = 32;
+        int min_batches = 10;
+        double alpha = 0.05;
+        int batch_size = 1;
+        int last_epoch = -1;
+        // num[b][m] / den[b][m] is metric m's mean over batch b
+        std::vector<std::vector<double>> num;
+        std::vector<std::vector<double>> den;
+
+        int n_metrics();
+        void add(int epoch, int metric, double x, double n);
+        void merge_pairs(std::vector<std::vector<double>> &xs);
+        std::vector<double> batch_means(int metric, int batches, int size);
+};
+#endif
@@ -0,0 +1,51 @@
+#ifndef CAPACITYSEARCH_H
+#define CAPACITYSEARCH_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include "SimConfig.h"
+#include "RunStatistics.h"
+#include "StatUtils.h"
+
+// Finds the smallest number of individual servers (group servers held fixed)
+// for which every pathway meets a target, e.g. p90 wait <= 26 weeks.
+// Each candidate is evaluated on paired replications (common seeds) and
+// replications are added sequentially until the confidence interval lies on
+// one side of the threshold, or max_reps is reached.
+class CapacitySearch{
+    public:
+        CapacitySearch(SimConfig cfg, std::string metric, double threshold,
+                    double quantile, int min_reps, int max_reps,
+                    double confidence, float start_utilization);
+
+        int run();  // returns the smallest feasible number of servers
+        void write_results(std::string path);
+
+    private:
+        struct Evaluation{
+            int n_servers;
+            std::vector<std::vector<double>> samples;  // [pathway][rep]
+            std::vector<ConfidenceInterval> cis;        // per pathway
+            int verdict = -1;   // 1: feasible, 0: infeasible, -1: undecided
+            bool decided = false;   // false if max_reps was hit without separating from threshold
+        };
+
+        SimConfig cfg;
+        std::string metric;     // "wait_quantile" or "age_out_rate"
+        double threshold;
+        double quantile;
+        int min_reps;
+        int max_reps;
+        double confidence;
+        float start_utilization;
+        std::map<int, Evaluation> evaluations;
+        long epochs_simulated = 0;
+        int result = -1;
+
+        bool is_feasible(int n_servers);
+        Evaluation& evaluate(int n_servers);
+        double get_metric(const RunStatistics &stats, int p);
+        void classify(Evaluation &ev);
+};
+#endif
@@ -0,0 +1,42 @@
+#ifndef CLASSSELECTOR_H
+#define CLASSSELECTOR_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "WaitlistEntry.h"
+
+// indexed binary heap over the heads of the non-empty waitlist classes;
+// the waitlist reports head changes so each selection is O(log classes)
+class ClassSelector{
+    public:
+        enum Policy {LONGEST_WAIT, AGE_URGENCY, WEIGHTED_FAIR};
+
+        ClassSelector();
+        ClassSelector(Policy policy, int n_classes, std::vector<double> weights = {});
+
+        static bool is_indexed(const std::string &name);    // false for the legacy "priority"/"random"
+        static Policy parse(const std::string &name);
+
+        void on_head_changed(int c, const WaitlistEntry *head);    // nullptr once class c is empty
+        void on_admit(int c);   // call before the admitted head is popped
+        int top() const;        // -1 when every class is empty
+        bool empty() const;
+        void check_invariants(uint64_t nonempty_mask) const;
+
+    private:
+        Policy policy = LONGEST_WAIT;
+        std::vector<int> heap;      // class ids, best first
+        std::vector<int> pos;       // heap index of each class, -1 if absent
+        std::vector<double> keys;   // smaller key is selected first
+        std::vector<double> weights;
+        std::vector<long> served;   // admissions per class (WEIGHTED_FAIR)
+
+        double key_of(int c, const WaitlistEntry &head) const;
+        bool before(int a, int b) const;
+        void swap_nodes(int i, int j);
+        void sift_up(int i);
+        void sift_down(int i);
+        void remove(int c);
+};
+#endif
@@ -0,0 +1,71 @@
+#ifndef DATASETWRITER_H
+#define DATASETWRITER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "arrow/io/file.h"
+#include "parquet/stream_writer.h"
+
+struct DischargeRecord;
+
+// Writes discharges as a hive-partitioned dataset:
+//   <root>/scenario=<s>/run=<r>/pathway=<p>/part-<k>.parquet
+// using the compact schema. runs_per_file consecutive runs are coalesced into
+// each file; the partition is then runs=<first>-<last> for the whole block (the
+// last block ends at run n_runs-1) and
+// the run_id column identifies the run of each row. close() writes a _metadata summary
+// (footers of all files) and a _manifest.csv so readers can prune partitions.
+// Shards writing into the same dataset use distinct part indexes; consolidate()
+// then folds their _metadata_<k> / _manifest_<k>.csv into single files.
+class DatasetWriter{
+    public:
+        DatasetWriter(std::string root, int scenario_id, int n_pathways, int runs_per_file, int n_runs);
+        ~DatasetWriter();
+
+        void begin_run(int run);
+        void write(const DischargeRecord &record);
+        void close();
+
+        // member-variable setters
+        void set_part(int part);    // file index within a partition, for concurrent writers
+
+        static void consolidate(std::string root);
+
+        struct PartitionFile{
+            std::string rel_path;   // relative to the scenario directory
+            int scenario;
+            int pathway;
+            int first_run;
+            int last_run;
+            long n_rows = 0;
+        };
+
+    private:
+
+        std::string root;
+        int scenario_id;
+        int n_pathways;
+        int runs_per_file;
+        int n_runs;
+        int part = 0;
+        std::string suffix = "";    // "_<part>" once set_part is called
+        int run = -1;
+        int block = -1;     // block of runs sharing the open files
+        bool closed = false;
+        std::vector<std::shared_ptr<arrow::io::FileOutputStream>> outfiles;    // per pathway
+        std::vector<parquet::StreamWriter> writers;     // per pathway
+        std::vector<int> open_files;    // per pathway, index into files
+        std::vector<PartitionFile> files;
+
+        std::string run_partition(int first_run);   // "run=<r>" or "runs=<first>-<last>"
+        void open_block(int first_run);
+        void close_block();
+
+        // _metadata<suffix> and _manifest<suffix>.csv in dir for the given files
+        static void write_summary(std::string dir, const std::vector<PartitionFile> &files,
+                                std::string path_prefix, std::string suffix);
+        static std::vector<PartitionFile> read_manifest(std::string path);
+};
+#endif
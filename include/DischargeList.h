@@ -2,30 +2,86 @@
 #define DISCHARGELIST_H
 
 #include <vector>
+#include <memory>
 #include "Patient.h"
+#include "RunStatistics.h"
+#include "WaitlistEntry.h"
+#include "DatasetWriter.h"
+#include "AppointmentLog.h"
+#include "BatchMeans.h"
+#include "DischargeSampler.h"
 
 #include "arrow/io/file.h"
 #include "parquet/stream_writer.h" 
 
+// output settings shared by the discharge writers
+struct OutputOptions{
+    bool compact = false;   // narrow types, derived columns dropped, run/scenario ids (SetupSchema_Compact)
+    int run_id = 0;
+    int scenario_id = 0;
+    DatasetWriter *dataset = nullptr;   // route rows to a partitioned dataset instead of a file
+    int sample_size = 0;    // reservoir per pathway and outcome instead of every row, 0 = off (file output only)
+    unsigned int sample_seed = 0;
+};
+
+// one discharge row; derived columns (sojourn, pct_face, age) are computed on write
+struct DischargeRecord{
+    int patient_id;     // -1 for waitlist age-outs, which are never admitted
+    int pathway;
+    int base_duration;
+    int arrival_t;
+    float arrival_age;
+    int first_appt;
+    int n_appts;
+    int discharge_t;
+    int n_ext;
+    int total_wait_time;
+    int discharge_duration;
+    int modality_sum;
+    int age_out;
+
+    static DischargeRecord from_patient(Patient &patient);
+    static DischargeRecord from_aged_out(const WaitlistEntry &entry, int epoch);
+    void write_compact(parquet::StreamWriter &os, int scenario_id, int run_id) const;
+};
+
 class DischargeList{
     public:
         DischargeList();
         DischargeList(std::string p);
+        DischargeList(std::string p, OutputOptions options);
+        DischargeList(OutputOptions options);   // streams to options.dataset
 
         void add_patient(Patient patient);
+        void add_aged_out(const WaitlistEntry &entry, int epoch);  // aged out before admission
+        void add_appointment(Patient &patient, int epoch);  // logs the patient's latest visit, if enabled
         int get_n_patients();
+        void write_sample();    // writes the sampled rows; call once the run is over
+        void copy_statistics(const DischargeList &other);  // counters only, outputs are not shared
         int size();
 
         // member-variable setters
         void set_path(std::string pathways);
+        void set_warmup(int warmup);
+        void set_appointment_log(std::string path);
+        void set_batch_means(BatchMeans *batch_means);     // also feed discharges to batch means
 
         std::vector<Patient> get_discharge_list();
+        RunStatistics& get_statistics();
     
     private:
         std::vector<Patient> discharge_list;
         std::string path;
         parquet::StreamWriter os;
+        bool streaming = false; // false when constructed without an output path or dataset
+        OutputOptions options;
         int n_patients = 0;
+        RunStatistics stats;
+        std::unique_ptr<AppointmentLog> appointment_log;
+        BatchMeans *batch_means = nullptr;
+        std::unique_ptr<DischargeSampler> sampler;
 
+        void write_record(const DischargeRecord &record, double sample_weight = 1);
+        void check_record(const DischargeRecord &record);   // SIM_CHECK_INVARIANTS builds only
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,45 @@
+#ifndef DISCHARGESAMPLER_H
+#define DISCHARGESAMPLER_H
+
+#include <vector>
+#include <random>
+
+struct DischargeRecord;
+
+// Fixed-size uniform sample of discharge records in each stratum (pathway x
+// completed/aged out). Reservoirs use Li's Algorithm L: once a reservoir is
+// full, the number of records to pass over before the next replacement is
+// drawn directly, so the RNG is only used O(k log(n/k)) times per stratum.
+// Every kept record of a stratum stands for n_seen / k discharges; that
+// weight makes weighted totals and means over the sample unbiased.
+class DischargeSampler{
+    public:
+        DischargeSampler(int capacity, unsigned int seed);
+        ~DischargeSampler();
+
+        void offer(const DischargeRecord &record);
+
+        int get_n_strata();
+        const std::vector<DischargeRecord>& get_sample(int stratum);
+        long get_n_seen(int stratum);
+        double get_weight(int stratum);     // discharges represented by each kept record
+
+        static int stratum(int pathway, bool aged_out);
+
+    private:
+        struct Reservoir{
+            std::vector<DischargeRecord> sample;
+            long n_seen = 0;
+            long next = 0;      // 1-based index of the next record to keep once full
+            double w = 1;
+        };
+
+        int capacity;
+        std::mt19937 rng;
+        std::uniform_real_distribution<double> unif = std::uniform_real_distribution<double>(0, 1);
+        std::vector<Reservoir> reservoirs;
+
+        double uniform();   // in (0, 1]
+        void schedule(Reservoir &r);
+};
+#endif
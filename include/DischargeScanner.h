@@ -0,0 +1,46 @@
+#ifndef DISCHARGESCANNER_H
+#define DISCHARGESCANNER_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <utility>
+#include "parquet/api/reader.h"
+#include "RunStatistics.h"
+
+// reading side of simstats: discharge outputs (flat simulation_data_<run>.parquet
+// files or a hive dataset, either schema) back into per-run RunStatistics
+
+struct InputFile{
+    std::string path;
+    int n_row_groups = 0;
+    int run = -1;   // from the file name, when there is no run_id column
+};
+
+struct ScanTask{
+    int file;
+    int row_group;
+};
+
+using RunKey = std::pair<int, int>;    // (scenario, run)
+
+// the discharge files under input: simulation_data_<run>.parquet files and the
+// discharges/ dataset, or input itself if it is a file; throws on --discharge_sample output
+std::vector<InputFile> find_discharge_inputs(std::string input);
+
+// decodes only the columns the statistics need; one scanner per thread
+class DischargeScanner{
+    public:
+        DischargeScanner(std::vector<InputFile> files, int warmup);
+
+        // adds the row group's discharges to the statistics of their run
+        void scan(ScanTask task, std::map<RunKey, RunStatistics> &stats);
+
+    private:
+        std::vector<InputFile> files;
+        int warmup;
+        int open_file = -1;
+        std::unique_ptr<parquet::ParquetFileReader> reader;
+};
+#endif
@@ -0,0 +1,50 @@
+#ifndef FEDERATION_H
+#define FEDERATION_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "SimConfig.h"
+#include "RunStatistics.h"
+#include "WaitlistEntry.h"
+
+// Several sites, each with its own servers, waitlist and discharge output,
+// simulated in one process with one thread per site. Sites advance in
+// lockstep: every epoch ends at a shared barrier. A new arrival is referred
+// to another (uniformly chosen) site with probability transfer_prob; the
+// referral is posted to a per-epoch outbox and joins the receiving site's
+// waitlist at the start of the next epoch, keeping its arrival time.
+// Outboxes are double-buffered by epoch parity, so a single barrier per epoch
+// separates writers from readers. Inboxes are drained in site order and every
+// site has its own RNG streams, so results do not depend on thread scheduling.
+class Federation{
+    public:
+        Federation(SimConfig cfg, int n_sites, std::vector<int> site_servers,
+                std::vector<double> site_arr_lam, double transfer_prob);
+
+        // runs replication `run`; discharges go to folder/site=<s>/ when write_output
+        std::vector<RunStatistics> run(int run, bool write_output);
+        void write_results(std::string path);
+
+        struct SiteReport{
+            long arrivals = 0;      // generated at the site, referrals out included
+            long referred_out = 0;
+            long referred_in = 0;
+            long discharged = 0;
+            long waitlist = 0;
+        };
+
+    private:
+        struct Site;
+        class Barrier;
+
+        SimConfig cfg;
+        int n_sites;
+        double transfer_prob;
+        std::vector<SimConfig> site_cfgs;
+        std::vector<SiteReport> reports;
+        std::vector<std::vector<WaitlistEntry>> outbox[2];  // [parity][src * n_sites + dst]
+
+        void run_site(Site &site, Barrier &barrier);
+};
+#endif
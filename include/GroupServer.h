@@ -12,10 +12,15 @@ class GroupServer : public Server {
         GroupServer(int path, int path_len, int max_caseload,
             float group_size_effect, 
             Waitlist &wl, DischargeList &dl);
+        GroupServer(const GroupServer &other, Waitlist &wl, DischargeList &dl);
 
         ~GroupServer(){};
 
         virtual void process_epoch(int epoch);
+        bool form_group(int epoch);   // fills an idle server from its pathway, false if none waiting
+
+        bool is_idle();
+        int get_path();
 
     private:
         int path; // indexes the pathway the server serves
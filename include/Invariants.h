@@ -0,0 +1,32 @@
+#ifndef INVARIANTS_H
+#define INVARIANTS_H
+
+#include <stdexcept>
+#include <string>
+
+// Internal consistency checks, compiled in with -DSIM_CHECK_INVARIANTS=ON
+// (always on in the stress target) and compiled out of release builds.
+// A failed check throws std::logic_error naming the condition and location.
+#ifdef SIM_CHECK_INVARIANTS
+#define SIM_INVARIANT(cond, msg) \
+    do { \
+        if (!(cond)) { \
+            throw std::logic_error(std::string("Invariant failed: ") + (msg) + " [" #cond "] at " \
+                                + __FILE__ + ":" + std::to_string(__LINE__)); \
+        } \
+    } while (0)
+#else
+// unevaluated, but the operands still count as used
+#define SIM_INVARIANT(cond, msg) do { (void)sizeof(cond); (void)sizeof(msg); } while (0)
+#endif
+
+namespace invariants {
+    constexpr bool enabled(){
+#ifdef SIM_CHECK_INVARIANTS
+        return true;
+#else
+        return false;
+#endif
+    }
+}
+#endif
@@ -0,0 +1,83 @@
+#ifndef MEMORYTRACKER_H
+#define MEMORYTRACKER_H
+
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <string>
+#include <utility>
+#include <cstddef>
+
+// Optional allocation accounting, enabled with -DSIM_MEMORY_TRACKING=ON.
+// Containers declared through tracked_vector/tracked_deque count allocations
+// and live bytes against a subsystem; when tracking is off they are plain
+// std containers and nothing is counted.
+namespace memory_tracker {
+    enum Subsystem {WAITLIST, CASELOAD, APPOINTMENTS, N_SUBSYSTEMS};
+
+    struct Counters{
+        std::atomic<long> n_allocs{0};
+        std::atomic<long> live_bytes{0};
+        std::atomic<long> peak_bytes{0};
+    };
+
+    Counters& counters(Subsystem s);
+    const char* name(Subsystem s);
+    bool enabled();
+
+    void on_alloc(Subsystem s, std::size_t bytes);
+    void on_free(Subsystem s, std::size_t bytes);
+
+    long heap_allocations();    // every operator new call, tracked or not
+    void start_run();           // allocs := 0 and peak := live, so the report covers one run
+
+    // samples heap allocations once per epoch
+    struct EpochSampler{
+        long last = 0;
+        long max = 0;
+        long total = 0;
+        int n_epochs = 0;
+
+        void start();
+        void sample();
+    };
+
+    // (label, value) pairs for the run summary
+    std::vector<std::pair<std::string, double>> report(const EpochSampler &sampler);
+};
+
+template <typename T, memory_tracker::Subsystem S>
+struct TrackingAllocator{
+    using value_type = T;
+    template <typename U> struct rebind { using other = TrackingAllocator<U, S>; };
+
+    TrackingAllocator() noexcept {}
+    template <typename U> TrackingAllocator(const TrackingAllocator<U, S> &) noexcept {}
+
+    T* allocate(std::size_t n){
+        memory_tracker::on_alloc(S, n * sizeof(T));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T *p, std::size_t n) noexcept {
+        memory_tracker::on_free(S, n * sizeof(T));
+        ::operator delete(p);
+    }
+};
+
+template <typename T, typename U, memory_tracker::Subsystem S>
+bool operator==(const TrackingAllocator<T, S> &, const TrackingAllocator<U, S> &){return true;}
+template <typename T, typename U, memory_tracker::Subsystem S>
+bool operator!=(const TrackingAllocator<T, S> &, const TrackingAllocator<U, S> &){return false;}
+
+#ifdef SIM_MEMORY_TRACKING
+template <typename T, memory_tracker::Subsystem S>
+using tracked_vector = std::vector<T, TrackingAllocator<T, S>>;
+template <typename T, memory_tracker::Subsystem S>
+using tracked_deque = std::deque<T, TrackingAllocator<T, S>>;
+#else
+template <typename T, memory_tracker::Subsystem S>
+using tracked_vector = std::vector<T>;
+template <typename T, memory_tracker::Subsystem S>
+using tracked_deque = std::deque<T>;
+#endif
+#endif
@@ -4,6 +4,10 @@
 #include <vector>
 #include <array>
 #include <random>
+#include "MemoryTracker.h"
+
+// attendance outcome of a booked appointment (att_probs columns)
+enum AttendanceOutcome {ATTENDED, NO_SHOW, LATE_CANCEL, ADVANCE_CANCEL};
 
 class Patient{
     public:
@@ -34,6 +38,7 @@ class Patient{
         void set_age_out(int a);
         void set_modality_policy(double p);
         void set_modality_dstb(std::uniform_real_distribution<> dstb);
+        void set_id(int id);
 
         // getter methods
         int get_pathway();
@@ -51,6 +56,9 @@ class Patient{
         int get_age_out();
         float get_pct_face();
         int get_modality_sum();
+        int get_id();
+        int get_last_modality();    // of the latest process_patient call
+        int get_last_outcome();     // AttendanceOutcome of the latest process_patient call
 
     private:
         int arrival_time;
@@ -60,7 +68,11 @@ class Patient{
         int service_duration;
         double serv_red_beta;
         int serv_red_cap;
-        std::vector<int> appt_epochs;
+        int first_appt = -1;    // epoch of the first attended appointment
+        int n_appts = 0;        // attended appointments; the full history goes to the AppointmentLog
+        int id = -1;            // admission order within the run
+        int last_modality = -1;
+        int last_outcome = -1;
         int modality_sum = 0;
         int extended = 0;
         double ext_prob_cap;
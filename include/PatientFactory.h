@@ -0,0 +1,29 @@
+#ifndef PATIENTFACTORY_H
+#define PATIENTFACTORY_H
+
+#include <vector>
+#include <array>
+#include <random>
+#include "Patient.h"
+#include "WaitlistEntry.h"
+
+// holds the per-class service parameters needed to turn a waitlist entry
+// into a Patient
+class PatientFactory{
+    public:
+        PatientFactory();   // unconfigured placeholder; make_patient throws until replaced
+        PatientFactory(std::vector<double> wait_effects, std::vector<double> modality_effects,
+                    std::vector<double> modality_policies,
+                    const std::array<std::array<double, 4>, 2> &att_probs);
+
+        // each patient gets its own stream, seeded from gen; throws if the
+        // factory has no parameters for the entry's pathway
+        Patient make_patient(const WaitlistEntry &entry, std::mt19937 &gen, int id);
+
+    private:
+        std::vector<double> wait_effects;
+        std::vector<double> modality_effects;
+        std::vector<double> modality_policies;
+        std::array<std::array<double, 4>, 2> att_probs;    // cumulative
+};
+#endif
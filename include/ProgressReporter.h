@@ -0,0 +1,40 @@
+#ifndef PROGRESSREPORTER_H
+#define PROGRESSREPORTER_H
+
+#include <string>
+#include <chrono>
+
+// Periodic progress line on stderr (epochs, throughput, ETA, waitlist, RSS) and
+// an optional JSON status file, replaced atomically so pollers never see a
+// partial write. update() is called every epoch and only reads the clock.
+class ProgressReporter{
+    public:
+        ProgressReporter();     // disabled
+        ProgressReporter(double interval, std::string status_path, int run, int n_epochs);
+
+        void start();
+        void update(int epochs_done, long n_arrivals, long n_discharged, int n_waitlist);
+        void finish(int epochs_done, long n_arrivals, long n_discharged, int n_waitlist);
+        bool is_enabled();
+
+        static long rss_bytes();    // resident set size, -1 where /proc is unavailable
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        bool enabled = false;
+        double interval = 0;    // seconds between reports
+        std::string status_path;
+        int run = 0;
+        int n_epochs = 0;
+        clock::time_point start_t;
+        clock::time_point next_t;
+        // counters at the previous report, for the current rates
+        clock::time_point last_t;
+        int last_epochs = 0;
+        long last_discharged = 0;
+
+        void report(int epochs_done, long n_arrivals, long n_discharged, int n_waitlist, bool final);
+        void write_status(const std::string &json);
+};
+#endif
@@ -13,7 +13,8 @@ using parquet::Type;
 using parquet::schema::GroupNode;
 using parquet::schema::PrimitiveNode;
 
-static std::shared_ptr<GroupNode> SetupSchema() {
+// sample_weight: extra column written by sampled output (DischargeSampler)
+static std::shared_ptr<GroupNode> SetupSchema(bool sample_weight = false) {
     parquet::schema::NodeVector fields;
 
     fields.push_back(PrimitiveNode::Make("class", Repetition::REQUIRED,
@@ -61,11 +62,173 @@ static std::shared_ptr<GroupNode> SetupSchema() {
     fields.push_back(PrimitiveNode::Make("age", Repetition::REQUIRED,
                                         Type::FLOAT, parquet::ConvertedType::NONE));
 
+    if (sample_weight) {
+        fields.push_back(PrimitiveNode::Make("sample_weight", Repetition::REQUIRED,
+                                            Type::DOUBLE, parquet::ConvertedType::NONE));
+    }
+
     return std::static_pointer_cast<GroupNode>(
         GroupNode::Make("schema", Repetition::REQUIRED, fields));
         
 }
 
+// compact discharge schema (--compact_output):
+// - narrow integer types for small-valued columns, boolean age_out
+// - sojourn_time, pct_face and age are dropped; they are derived as
+//   discharge_t - arrival_t, modality_sum / n_appts and
+//   arrival_age + (discharge_t - arrival_t) / 52
+// - scenario_id and run_id so files from many runs can be scanned together
+// - patient_id joins rows to the appointment log (-1 for waitlist age-outs)
+static std::shared_ptr<GroupNode> SetupSchema_Compact(bool sample_weight = false) {
+    parquet::schema::NodeVector fields;
+
+    fields.push_back(PrimitiveNode::Make("scenario_id", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("run_id", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("patient_id", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("class", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_8));
+
+    fields.push_back(PrimitiveNode::Make("base_duration", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_16));
+
+    fields.push_back(PrimitiveNode::Make("arrival_t", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("arrival_age", Repetition::REQUIRED,
+                                        Type::FLOAT, parquet::ConvertedType::NONE));
+
+    fields.push_back(PrimitiveNode::Make("first_appt", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("n_appts", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_16));
+
+    fields.push_back(PrimitiveNode::Make("discharge_t", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("n_ext", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_8));
+
+    fields.push_back(PrimitiveNode::Make("total_wait_time", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("discharge_duration", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_16));
+
+    fields.push_back(PrimitiveNode::Make("modality_sum", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_16));
+
+    fields.push_back(PrimitiveNode::Make("age_out", Repetition::REQUIRED,
+                                        Type::BOOLEAN, parquet::ConvertedType::NONE));
+
+    if (sample_weight) {
+        fields.push_back(PrimitiveNode::Make("sample_weight", Repetition::REQUIRED,
+                                            Type::DOUBLE, parquet::ConvertedType::NONE));
+    }
+
+    return std::static_pointer_cast<GroupNode>(
+        GroupNode::Make("schema", Repetition::REQUIRED, fields));
+
+}
+
+// Rows are written in discharge order, so row groups are sorted by
+// discharge_t and their min/max statistics let readers skip whole groups.
+// Time columns are delta encoded, the rest dictionary/RLE encoded.
+static std::shared_ptr<parquet::WriterProperties> CompactWriterProperties() {
+    parquet::WriterProperties::Builder builder;
+    builder.compression(parquet::Compression::ZSTD)
+        ->enable_dictionary()
+        ->enable_statistics()
+        ->max_row_group_length(1 << 20)
+        ->disable_dictionary("discharge_t")
+        ->encoding("discharge_t", parquet::Encoding::DELTA_BINARY_PACKED)
+        ->disable_dictionary("arrival_t")
+        ->encoding("arrival_t", parquet::Encoding::DELTA_BINARY_PACKED)
+        ->disable_dictionary("patient_id")
+        ->encoding("patient_id", parquet::Encoding::DELTA_BINARY_PACKED);
+    return builder.build();
+}
+
+// appointment event log (--appointment_log), one row per booked visit
+static std::shared_ptr<GroupNode> SetupSchema_Appointments() {
+    parquet::schema::NodeVector fields;
+
+    fields.push_back(PrimitiveNode::Make("patient_id", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("epoch", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("modality", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_8));
+
+    fields.push_back(PrimitiveNode::Make("outcome", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_8));
+
+    return std::static_pointer_cast<GroupNode>(
+        GroupNode::Make("schema", Repetition::REQUIRED, fields));
+
+}
+
+// events arrive in epoch order, so epoch deltas are almost all zero; patient
+// ids cycle through a server's caseload and delta-encode to small values
+static std::shared_ptr<parquet::WriterProperties> AppointmentWriterProperties() {
+    parquet::WriterProperties::Builder builder;
+    builder.compression(parquet::Compression::ZSTD)
+        ->enable_dictionary()
+        ->enable_statistics()
+        ->disable_dictionary("epoch")
+        ->encoding("epoch", parquet::Encoding::DELTA_BINARY_PACKED)
+        ->disable_dictionary("patient_id")
+        ->encoding("patient_id", parquet::Encoding::DELTA_BINARY_PACKED);
+    return builder.build();
+}
+
+// slot accounting (--utilisation_log), one row per (epoch, server type, pathway, state)
+static std::shared_ptr<GroupNode> SetupSchema_Utilisation() {
+    parquet::schema::NodeVector fields;
+
+    fields.push_back(PrimitiveNode::Make("epoch", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("server_type", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_8));
+
+    fields.push_back(PrimitiveNode::Make("pathway", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_8));
+
+    fields.push_back(PrimitiveNode::Make("state", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_8));
+
+    fields.push_back(PrimitiveNode::Make("slots", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    fields.push_back(PrimitiveNode::Make("capacity", Repetition::REQUIRED,
+                                        Type::INT32, parquet::ConvertedType::INT_32));
+
+    return std::static_pointer_cast<GroupNode>(
+        GroupNode::Make("schema", Repetition::REQUIRED, fields));
+
+}
+
+// rows repeat the same (type, pathway, state) cycle every epoch, so every
+// column but epoch is dictionary-friendly and epoch delta-encodes to ~0
+static std::shared_ptr<parquet::WriterProperties> UtilisationWriterProperties() {
+    parquet::WriterProperties::Builder builder;
+    builder.compression(parquet::Compression::ZSTD)
+        ->enable_dictionary()
+        ->enable_statistics()
+        ->disable_dictionary("epoch")
+        ->encoding("epoch", parquet::Encoding::DELTA_BINARY_PACKED);
+    return builder.build();
+}
+
 static std::shared_ptr<GroupNode> SetupSchema_Waitlist() {
     parquet::schema::NodeVector fields;
 
@@ -0,0 +1,29 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <vector>
+#include <string>
+#include "SimConfig.h"
+#include "RunStatistics.h"
+#include "DatasetWriter.h"
+#include "DischargeList.h"
+#include "Waitlist.h"
+#include "Simulation.h"
+
+// number of individual servers needed to reach a target utilization
+int utilization_to_servers(float utilization, std::vector<int> pathways,
+                            std::vector<double> probs, double arr_lam);
+
+// the simulation for cfg around dl and wl; servers are not generated and the
+// arrival stream is not seeded yet
+Simulation make_simulation(const SimConfig &cfg, DischargeList &dl, Waitlist &wl,
+                        std::string waitlist_path = "");
+
+// runs one replication of cfg; RNG streams are derived from (cfg.seed, run)
+// so the same run index gives common random numbers across configurations.
+// empty paths disable parquet output; a dataset replaces run_path.
+RunStatistics run_replication(const SimConfig &cfg, int run,
+                            std::string run_path = "", std::string waitlist_path = "",
+                            DatasetWriter *dataset = nullptr, std::string appointment_path = "",
+                            std::string utilisation_path = "");
+#endif
@@ -0,0 +1,47 @@
+#ifndef RESULTSCACHE_H
+#define RESULTSCACHE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <ostream>
+#include "SimConfig.h"
+#include "RunStatistics.h"
+
+// bump whenever a change alters simulated results, so older cache entries miss
+constexpr int ENGINE_VERSION = 1;
+
+// on-disk cache of per-run results, content-addressed by a hash of every
+// result-affecting parameter, the seed, the run index and ENGINE_VERSION.
+// Each entry is a directory <cache_dir>/<hash>/ holding
+//   key.txt       canonical parameter text (checked on lookup against collisions)
+//   stats.txt     RunStatistics::save output
+//   outputs-<h>/  optional copies of the run's output files, one per output variant
+class ResultsCache{
+    public:
+        ResultsCache(std::string dir);
+
+        // canonical "name=value" lines; output locations and reporting are left out
+        static std::string config_key(const SimConfig &cfg, int run);
+        // which optional files a run writes (compact schema, waitlist, appointment and utilisation logs)
+        static std::string output_variant(const SimConfig &cfg);
+        static uint64_t fnv1a(const std::string &text);
+
+        bool lookup(const std::string &key, RunStatistics &stats);
+        void store(const std::string &key, const RunStatistics &stats);
+        // outputs are (path relative to the output folder, absolute path) pairs
+        bool restore_outputs(const std::string &key, const std::string &variant, std::string folder);
+        void store_outputs(const std::string &key, const std::string &variant,
+                        const std::vector<std::pair<std::string, std::string>> &files);
+
+        void list(std::ostream &out);
+        void evict(double max_mb);  // least recently used first, until at most max_mb remain
+        void clear();
+
+    private:
+        std::string dir;
+
+        std::string entry_dir(const std::string &key);
+        void touch(const std::string &key);
+};
+#endif
@@ -0,0 +1,85 @@
+#ifndef RUNSTATISTICS_H
+#define RUNSTATISTICS_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <iostream>
+#include "Patient.h"
+#include "WaitlistEntry.h"
+#include "BatchMeans.h"
+
+// integer-valued histogram (values in epochs or appointment counts)
+// mergeable, so per-run histograms can be pooled exactly
+struct Histogram{
+    std::vector<long> counts;
+    long n = 0;
+    double sum = 0;
+
+    void add(int value);
+    void merge(const Histogram &other);
+    double mean() const;
+    double quantile(double q) const;  // NaN if empty
+
+    void write(std::ostream &out) const;    // sparse "n sum n_bins (bin count)..." line
+    void read(std::istream &in);
+};
+
+// summary statistics for a single pathway, accumulated from the discharge stream
+struct PathwayStatistics{
+    long n_discharged = 0;
+    long n_completed = 0;           // discharged after completing service
+    long n_aged_out = 0;            // aged out either on the waitlist or in service
+    long n_waitlist_age_out = 0;    // aged out before being admitted
+    long n_treated = 0;             // received at least one appointment
+    double sum_pct_face = 0;
+    Histogram wait;     // waitlist time (time to age-out for waitlist age-outs)
+    Histogram sojourn;
+    Histogram n_appts;
+
+    void merge(const PathwayStatistics &other);
+    double age_out_rate() const;
+    double mean_pct_face() const;
+};
+
+class RunStatistics{
+    public:
+        RunStatistics();
+        RunStatistics(int warmup);
+
+        void add_patient(Patient &patient);
+        void add_aged_out(const WaitlistEntry &entry, int epoch);   // waitlist age-out
+        // one discharge from its output columns (used when reading results back)
+        void add_discharge(int pathway, int arrival_t, int wait, int sojourn, int n_appts,
+                        int modality_sum, bool age_out, bool waitlist_age_out);
+        void merge(const RunStatistics &other);
+
+        int n_pathways() const;
+        PathwayStatistics& pathway(int p);
+        const PathwayStatistics& pathway(int p) const;
+
+        // flattened (label, value) pairs for write_csv
+        std::vector<std::pair<std::string, double>> summary() const;
+
+        // exact text serialization (counters and histograms), so runs from
+        // separate processes can be merged later; load throws on a bad file
+        void save(std::string path) const;
+        static RunStatistics load(std::string path);
+
+        // member-variable setters
+        void set_warmup(int warmup);
+
+        // run-level counters, filled in by the caller at the end of a run
+        long n_arrivals = 0;
+        long n_discharged = 0;
+        long n_waitlist = 0;
+        long epochs_run = 0;
+        int stable = 1;     // 0 if the run was stopped early as diverging
+        std::vector<std::pair<std::string, double>> memory;    // SIM_MEMORY_TRACKING report, not merged
+        std::vector<BatchMeansEstimate> batch_means;    // --batch_means only, not merged or saved
+
+    private:
+        int warmup = 0; // patients arriving before warmup are excluded
+        std::vector<PathwayStatistics> pathways;
+};
+#endif
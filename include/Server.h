@@ -1,15 +1,19 @@
 #ifndef SERVER_H
 #define SERVER_H
 
-#include <deque>
+#include <vector>
+#include <optional>
 #include "Patient.h"
 #include "Waitlist.h"
 #include "DischargeList.h"
+#include "MemoryTracker.h"
+#include "UtilisationLog.h"
 
 class Server{
     public:
         Server(Waitlist &wl, DischargeList &dl);
         Server(int max_caseload, Waitlist &wl, DischargeList &dl);
+        Server(const Server &other, Waitlist &wl, DischargeList &dl);  // same caseload, bound to wl/dl
 
         ~Server() {};
 
@@ -18,18 +22,41 @@ class Server{
         void process_extension(Patient patient, int epoch);
         virtual void process_epoch(int epoch);
 
+        bool has_capacity();    // fewer than max_caseload patients
+        int get_n_patients();
+        void check_invariants();    // SIM_CHECK_INVARIANTS builds only
+        void reseed_patients(std::mt19937 &gen);
+
         // setters
         void set_max_caseload(int max_caseload);
+        void set_next_free(int next);
+        void set_utilisation_log(UtilisationLog *log, int first_slot);    // slot bits start at first_slot
+
+        // getters
+        int get_next_free();
+        int get_max_caseload();
 
         void print_patients();
 
     protected:
-        std::deque<Patient> caseload = std::deque<Patient>();
-        int n_patients = 0;
+        // caseload ring: patients live in max_caseload fixed slots and are
+        // processed where they sit. order holds the occupied slots in visit
+        // order, cyclic from cursor (the next patient seen); a visit advances
+        // the cursor, an admission joins the back of the cycle (just before
+        // cursor) and a discharge frees its slot.
+        tracked_vector<std::optional<Patient>, memory_tracker::CASELOAD> caseload;
+        std::vector<int> order;
+        int cursor = 0;
+
+        Patient& patient_at(int i);     // i-th patient in visit order from cursor
+        void remove_current();          // drops the patient at cursor
         Waitlist& waitlist;
         DischargeList& discharge_list;
         int max_caseload = 1; // max allowable caseload -> impacts freq (i.e., 1 = weekly, 2 = bi-weekly, 4 = monthly, etc.)
         bool logging = false; // variable to use to report if patients are on waitlist or not
+        int next_free = -1;     // intrusive link in the simulation's free-capacity list
+        UtilisationLog *utilisation = nullptr;
+        int first_slot = 0;
 
 };
 #endif
\ No newline at end of file
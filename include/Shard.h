@@ -0,0 +1,26 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <vector>
+#include <string>
+
+// --shard i/N: the runs this process owns out of a replication set split
+// across N independent processes. Every run's RNG streams depend only on
+// (seed, run), so any split reproduces the unsharded results.
+struct ShardSpec{
+    int index = 0;
+    int count = 1;
+
+    static ShardSpec parse(std::string spec);  // "i/N", throws if malformed
+    // runs are dealt out in blocks of block_size consecutive runs (one
+    // coalesced partition file, see --runs_per_file), round-robin over shards
+    bool owns(int scenario_id, int run, int block_size = 1) const;
+    bool is_sharded() const;
+};
+
+// Copies each input folder's outputs into folder, then
+//   - pools every directory's stats_<run>.txt files into summary_merged.csv
+//     (pooled statistics plus across-run confidence intervals)
+//   - consolidates the shard manifests of a hive dataset (DatasetWriter::consolidate)
+void merge_shards(std::vector<std::string> inputs, std::string folder, double confidence);
+#endif
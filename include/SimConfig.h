@@ -0,0 +1,59 @@
+#ifndef SIMCONFIG_H
+#define SIMCONFIG_H
+
+#include <vector>
+#include <array>
+#include <string>
+
+// holds the full parameter set for a simulation run, as parsed from the command line
+struct SimConfig{
+    int n_epochs = 10000;
+    int waitlist_prefill = 0;
+    int n_servers = 80;
+    std::vector<int> n_group_servers = {0, 0, 0};  // number of group servers for each pathway
+    std::vector<float> group_size_props = {0, 0.33, 0.33, 0.33};
+    std::vector<float> group_size_effects = {0, 0, 0, 0};
+    int max_caseload = 1;
+    double arr_lam = 10;
+    std::vector<double> probs = {0.33, 0.33, 0.33};  // arrival probabilities for each class
+    std::string folder = "test/";
+    std::vector<int> pathways = {7, 10, 13};
+    std::vector<double> wait_effects = {0.6, 0.6, 0.6};
+    std::vector<double> modality_effects = {0.5, 0.0, -0.5};
+    std::vector<double> modality_policies = {0.5, 0, 1};
+    double max_ax_age = 3.0;
+    std::vector<double> age_params = {1.5, 1.0};
+    std::vector<int> p_order = {0, 1, 2};
+    bool priority_wlist = true;
+    std::string wl_policy = "priority";     // class selection, see Waitlist::set_selection_policy
+    std::vector<double> fair_weights = {};  // per-pathway weights for "fair", empty = equal
+    int runs = 1;
+    bool waitlist_logging = false;
+    // [0]: virtual, [1]: in person attendance probabilities (not cumulative)
+    std::array<std::array<double, 4>, 2> att_probs = {{{0.9, 0.025, 0.025, 0.05},
+                                                       {0.8, 0.05, 0.05, 0.1}}};
+    unsigned int seed = 0;  // global seed; per-run streams are derived from (seed, run)
+    int warmup = 0;         // epochs excluded from summary statistics (by arrival time)
+    std::string arrival_sampler = "alias";  // "alias" tables or the "reference" std distributions
+    std::string arrival_trace = "";     // parquet referral trace replayed instead of sampling (ArrivalTrace)
+    bool compact_output = false;    // compact discharge schema (SetupSchema_Compact)
+    int discharge_sample = 0;       // discharge rows kept per pathway and outcome, 0 = all (DischargeSampler)
+    int scenario_id = 0;
+    std::string output_layout = "flat";    // "flat" files per run or a "hive"-partitioned dataset
+    int runs_per_file = 1;          // runs coalesced into each partition file (hive layout)
+    bool appointment_log = false;   // per-visit event log (AppointmentLog)
+    bool utilisation_log = false;   // per-epoch slot accounting (UtilisationLog)
+    bool stability_check = false;   // stop diverging runs early (see StabilityMonitor)
+    int stability_window = 52;
+    int stability_min_windows = 6;
+    double stability_alpha = 0.01;
+    double stability_tolerance = 0.05;
+    bool batch_means = false;       // steady-state intervals from each run (see BatchMeans)
+    int batch_count = 32;
+    int batch_min = 10;
+    double batch_alpha = 0.05;
+    double batch_confidence = 0.95;
+    double progress_interval = 0;   // seconds between progress reports, 0 = off
+    std::string status_file = "";   // optional JSON status, rewritten atomically
+};
+#endif
@@ -3,10 +3,21 @@
 
 #include <vector>
 #include <random>
+#include <set>
+#include <memory>
+#include <functional>
 #include "Waitlist.h"
 #include "DischargeList.h"
 #include "Server.h"
 #include "GroupServer.h"
+#include "StabilityMonitor.h"
+#include "MemoryTracker.h"
+#include "AliasTable.h"
+#include "ProgressReporter.h"
+#include "BatchMeans.h"
+#include "ArrivalTrace.h"
+#include "UtilisationLog.h"
+#include "WaitlistEntry.h"
 
 class Simulation{
     public:
@@ -24,15 +35,27 @@ class Simulation{
         
         void generate_servers();
         void generate_arrivals(int epoch);
+        void form_groups(int epoch);
+        void admit_patients(int epoch);
         void prefill_waitlist(int n_patients);
         void run();
+        void step(int epoch);   // one epoch of run(), without progress or stability checks
+        // servers, waitlist, discharge counters and RNG of a simulation built from the
+        // same parameters, rebound to this simulation's waitlist and discharge list
+        void copy_state(const Simulation &other);
+        void reseed(std::mt19937 &gen);     // fresh arrival, waitlist and in-service patient streams
         void write_parquet(std::string path);
         void write_statistics(std::string path);
 
         int get_n_admitted();
+        bool is_unstable();
+        int get_epochs_run();
+        const memory_tracker::EpochSampler& get_alloc_sampler();
 
         int get_n_discharged();
         int get_n_waitlist();
+        int get_n_in_service();
+        void check_invariants(int epoch);   // SIM_CHECK_INVARIANTS builds only, once per epoch
 
         // member-variable setters
         void set_n_epochs(int n_epochs);
@@ -50,22 +73,39 @@ class Simulation{
         void set_n_classes(int n_classes);
         void set_class_dstb(std::discrete_distribution<> class_dstb);
         void set_age_dstb(std::normal_distribution<> age_dstb);
+        void set_age_table(double mean, double sd);
+        void set_alias_sampling(bool alias_sampling);
         void set_att_probs(double probs[2][4]);
         void set_waitlist_logging(bool waitlist_logging);
+        void set_rng(std::mt19937 gen);
+        void set_stability_monitor(StabilityMonitor monitor);   // enables early termination
+        void set_progress_reporter(ProgressReporter progress);
+        void set_batch_means(BatchMeans *batch_means);     // per-epoch utilisation and waitlist length
+        void set_arrival_trace(std::shared_ptr<ArrivalTrace> trace);   // replaces the Poisson arrivals
+        void set_utilisation_log(std::string path);    // after generate_servers
+        // called on each new arrival; returning true hands the referral to another site
+        void set_arrival_router(std::function<bool(const WaitlistEntry&)> router);
+        void receive_referrals(int epoch, const std::vector<WaitlistEntry> &entries);
+        long get_n_referred_in();
+        long get_n_referred_out();
         // void set_discharge_list(std::string path);
         // void set_waitlist(int n_classes, std::mt19937 &gen, double max_ax_age, DischargeList &dl);
         void stream_waitlist(int epoch);
 
         double get_arr_age();
+        double get_alias_arr_age();
+        WaitlistEntry make_arrival(int epoch);
         
     private:
         int n_epochs;
         int n_servers;
         std::vector<Server> servers;
+        int free_head = -1;     // head of the intrusive list of servers with open slots
         std::vector<int> n_group_servers;   // [0]: pathway index, [1]: number of servers
         std::vector<float> group_size_props; // proportion of servers to be 2, 3, 4 person groups
         std::vector<float> group_size_effects;
         std::vector<GroupServer> group_servers;
+        std::vector<std::set<int>> idle_group_servers;  // per pathway, indexes into group_servers
         int max_caseload;
         double arr_lam;
         std::vector<int> pathways; // map the integer key to string labels for classes outside of the simulation
@@ -79,9 +119,29 @@ class Simulation{
         Waitlist& wl;
         DischargeList& dl;
         int n_admitted = 0;
+        int n_prefilled = 0;
         std::discrete_distribution<> class_dstb;
         std::normal_distribution<> age_dstb;
+        std::poisson_distribution<> arr_dstb;   // cached, rebuilt only when arr_lam changes
+        bool alias_sampling = true;     // false: reference samplers (class_dstb, get_arr_age)
+        AliasTable class_table;
+        AliasTable age_table;   // clamp masses at either end, fine bins in between
+        std::vector<WaitlistEntry> arrival_batch;   // reused every epoch
         parquet::StreamWriter wl_os;
         bool waitlist_logging = false;
+        std::mt19937 rng;   // arrival stream, seeded per run
+        bool stability_check = false;
+        StabilityMonitor monitor;
+        int epochs_run = 0;
+        ProgressReporter progress;  // disabled unless set
+        BatchMeans *batch_means = nullptr;
+        std::shared_ptr<ArrivalTrace> trace;    // replayed arrivals, if set
+        std::unique_ptr<UtilisationLog> utilisation;
+        std::function<bool(const WaitlistEntry&)> router;  // federation only
+        long n_referred_in = 0;
+        long n_referred_out = 0;
+
+        void record_batch_means(int epoch);
+        memory_tracker::EpochSampler alloc_sampler;     // only sampled with SIM_MEMORY_TRACKING
 };
 #endif
@@ -0,0 +1,47 @@
+#ifndef SPLITTING_H
+#define SPLITTING_H
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <string>
+#include "SimConfig.h"
+#include "StatUtils.h"
+
+// Fixed-effort multilevel splitting for P(waitlist of a pathway reaches
+// levels.back() within horizon epochs), starting from the state after
+// cfg.warmup epochs of replication `rep`.
+// Stage k restarts `effort` trajectories, spread evenly over the states that
+// first reached levels[k-1] (the start state for k = 0). Each clone copies the
+// full in-memory state (waitlist, caseloads, counters) and gets fresh RNG
+// streams, then runs until it reaches levels[k] or the horizon. The product of
+// the stage hit fractions is an unbiased estimate; its variance comes from
+// independent repetitions (cfg.runs) of the whole procedure.
+class Splitting{
+    public:
+        Splitting(SimConfig cfg, int pathway, std::vector<int> levels, int horizon,
+                int effort, double confidence);
+
+        ConfidenceInterval run();
+        void write_results(std::string path);
+
+    private:
+        struct Trajectory;
+
+        SimConfig cfg;
+        int pathway;
+        std::vector<int> levels;
+        int horizon;
+        int effort;
+        double confidence;
+        std::vector<double> estimates;                  // per repetition
+        std::vector<std::vector<double>> stage_probs;   // [rep][stage]
+        ConfidenceInterval result;
+        long epochs_simulated = 0;
+
+        std::unique_ptr<Trajectory> make_trajectory(std::mt19937 &wl_gen);
+        std::unique_ptr<Trajectory> clone(const Trajectory &source, std::mt19937 &gen);
+        bool advance(Trajectory &t, int level, int end_epoch);
+        double estimate(int rep);
+};
+#endif
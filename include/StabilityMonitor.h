@@ -0,0 +1,48 @@
+#ifndef STABILITYMONITOR_H
+#define STABILITYMONITOR_H
+
+#include <vector>
+
+// Online check for runs whose waitlist is diverging (over capacity).
+// Epochs are grouped into windows; over the most recent min_windows windows
+// a run is declared unstable when admissions fall short of arrivals by more
+// than tolerance and either
+//   - a one-sided Mann-Kendall test finds an upward trend in the mean
+//     waitlist length at level alpha, or
+//   - the shortfall holds in every one of those windows (the waitlist has
+//     plateaued at the age-out limit)
+class StabilityMonitor{
+    public:
+        StabilityMonitor();
+        StabilityMonitor(int window, int min_windows, double alpha, double tolerance);
+
+        // cumulative arrival and admission counts, called once per epoch
+        void record(int waitlist_len, long arrivals, long admissions);
+        bool is_unstable();
+
+        double get_trend_z();
+        double get_deficit();   // (arrivals - admissions) / arrivals over the test windows
+
+    private:
+        int window = 52;
+        int min_windows = 6;
+        double alpha = 0.01;
+        double tolerance = 0.05;
+
+        long last_arrivals = 0;
+        long last_admissions = 0;
+        int n_in_window = 0;
+        double window_wl_sum = 0;
+        long window_arrivals = 0;
+        long window_admissions = 0;
+        std::vector<double> wl_means;       // per completed window
+        std::vector<long> arrivals;
+        std::vector<long> admissions;
+
+        bool unstable = false;
+        double trend_z = 0;
+        double deficit = 0;
+
+        void evaluate();
+};
+#endif
@@ -0,0 +1,23 @@
+#ifndef STATUTILS_H
+#define STATUTILS_H
+
+#include <vector>
+
+struct ConfidenceInterval{
+    double mean;
+    double lower;
+    double upper;
+    int n;
+};
+
+namespace stat_utils {
+    double normal_quantile(double p);
+    double t_quantile(int df, double p);
+
+    double mean(const std::vector<double> &xs);
+    double variance(const std::vector<double> &xs);  // sample variance (n - 1)
+
+    // two-sided t-interval for the mean, NaN samples are ignored
+    ConfidenceInterval mean_ci(const std::vector<double> &xs, double confidence);
+};
+#endif
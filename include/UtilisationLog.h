@@ -0,0 +1,60 @@
+#ifndef UTILISATIONLOG_H
+#define UTILISATIONLOG_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "arrow/io/file.h"
+#include "parquet/api/writer.h"
+#include "Patient.h"
+
+// Per-epoch server slot accounting (--utilisation_log). Every epoch each
+// server slot (one per individual server, one seat per group member) gets at
+// most one bit in a bitset per (server type, pathway, state). States are the
+// AttendanceOutcome of the visit that used the slot, or UNFILLED for empty
+// seats of a running group; slots with no bit set were idle. At the end of
+// the epoch the bitsets are popcounted into SetupSchema_Utilisation rows
+// (epoch, server_type, pathway, state, slots, capacity), pathway -1 and state
+// IDLE for idle slots, and buffered into one row group per batch of epochs.
+class UtilisationLog{
+    public:
+        enum ServerType {INDIVIDUAL, GROUP, N_SERVER_TYPES};
+        enum SlotState {UNFILLED = ADVANCE_CANCEL + 1, IDLE, N_SLOT_STATES};
+
+        UtilisationLog(std::string path, int n_pathways, int individual_slots, int group_slots,
+                    int batch_epochs = 4096);
+        ~UtilisationLog();
+
+        // inline, called for every slot every epoch
+        void mark(ServerType type, int slot, int pathway, int state) {
+            words[type][(pathway * IDLE + state) * words_per_type[type] + (slot >> 6)] |= uint64_t(1) << (slot & 63);
+        }
+        void end_epoch(int epoch);
+        void close();
+
+        // run totals, slot-epochs per state over both server types
+        long get_slots(int state);
+
+    private:
+        std::shared_ptr<arrow::io::FileOutputStream> outfile;
+        std::unique_ptr<parquet::ParquetFileWriter> writer;
+        int n_pathways;
+        int capacity[N_SERVER_TYPES];
+        int words_per_type[N_SERVER_TYPES];
+        int batch_epochs;
+        int epochs_buffered = 0;
+        std::vector<uint64_t> words[N_SERVER_TYPES];    // [(pathway * IDLE + state) * words_per_type + word]
+        std::vector<long> totals;       // per state
+        std::vector<int32_t> epochs;
+        std::vector<int32_t> server_types;
+        std::vector<int32_t> pathways;
+        std::vector<int32_t> states;
+        std::vector<int32_t> slots;
+        std::vector<int32_t> capacities;
+
+        void add_row(int epoch, int type, int pathway, int state, int n);
+        void flush();
+};
+#endif
@@ -4,13 +4,18 @@
 #include <iostream>
 #include <vector>
 #include <deque>
+#include <cstdint>
 #include "Patient.h"
 #include "DischargeList.h"
+#include "WaitlistEntry.h"
+#include "PatientFactory.h"
+#include "MemoryTracker.h"
+#include "ClassSelector.h"
 
 class Waitlist{
     public:
         std::vector<int> classes;
-        std::vector<std::deque<std::pair<Patient, int>>> waitlist;
+        std::vector<tracked_deque<WaitlistEntry, memory_tracker::WAITLIST>> waitlist;
         std::deque<Patient> reassignment_list;
         std::mt19937 rng;
 
@@ -22,18 +27,41 @@ class Waitlist{
                 std::mt19937 &gen, DischargeList &dl);
 
         int len_waitlist();
-        void add_patient(Patient &patient, int epoch);
+        bool is_empty();    // O(1), no age-out purge
+        long get_n_admissions();
+        void check_invariants();    // SIM_CHECK_INVARIANTS builds only
+        void add_patient(Patient &patient, int epoch);  // re-queue, service state is not kept
+        void add_entry(const WaitlistEntry &entry);
+        void add_entries(const std::vector<WaitlistEntry> &entries);
         int len_reassignments();
         void add_reassignment(Patient patient);
         std::pair<Patient, int> get_patient(int epoch);
         bool check_availability(int epoch);
         bool check_class_availability(int c, int epoch);
+        void set_patient_factory(PatientFactory factory);
+        // "priority"/"random" keep the legacy scan, "lwf"/"age"/"fair" use a ClassSelector
+        void set_selection_policy(std::string policy, std::vector<double> fair_weights = {});
+        // queue contents, RNG and counters of a waitlist built with the same settings
+        void copy_state(const Waitlist &other);
+        // dequeues up to k patients from class c in one call (aged-out heads are discharged)
+        std::vector<std::pair<Patient, int>> get_class_patients(int c, int k, int epoch);
     
     private:
         DischargeList& discharge_list;
         double max_ax_age;
         bool priority_wlist = false;    // flag to determine if priority waitlist is used
         std::vector<int> priority_order; // order of priority for waitlist
+        uint64_t nonempty_mask = 0;     // bit c set iff waitlist[c] is non-empty
+        PatientFactory factory;         // materialises entries on admission
+        long n_admissions = 0;          // entries admitted to service
+        bool indexed = false;           // selection via the class heap instead of classes
+        ClassSelector selector;
+
+        void head_changed(int c);
+        std::pair<Patient, int> get_indexed_patient(int epoch);
+
+        void pop_front(int c);
+        std::pair<Patient, int> admit_front(int c);
 
         // setter methods
         void set_max_ax_age(double max_ax_age);
@@ -0,0 +1,20 @@
+#ifndef WAITLISTENTRY_H
+#define WAITLISTENTRY_H
+
+#include <cstdint>
+
+// compact arrival record held on the waitlist; the full Patient (RNG,
+// appointment history, attendance probabilities) is only built on admission
+struct WaitlistEntry{
+    int32_t arrival_time;
+    float arrival_age;
+    int16_t pathway;
+    int16_t base_duration;
+    int32_t epoch;  // epoch the entry joined the waitlist
+
+    float get_age(int at_epoch) const {
+        return arrival_age + float(at_epoch - arrival_time)/52;    // convert weeks to years
+    }
+};
+static_assert(sizeof(WaitlistEntry) == 16, "WaitlistEntry should stay 16 bytes");
+#endif
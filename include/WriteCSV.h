@@ -5,7 +5,7 @@
 #include <vector>
 #include <fstream>
 
-void write_csv(std::string filename, std::vector<std::pair<std::string, double>> dataset) {
+inline void write_csv(std::string filename, std::vector<std::pair<std::string, double>> dataset) {
     std::ofstream file(filename);
 
     for (int j=0; j < dataset.size(); j++) {
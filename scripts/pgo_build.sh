@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+# Two-stage profile-guided build of the simulation target, with a speedup
+# report against the plain Release build on the training scenarios.
+#
+#   scripts/pgo_build.sh [build_root] [repeats]
+#
+# Produces <build_root>/plain, <build_root>/pgo-generate and <build_root>/pgo
+# (LTO + PGO). The optimised binary is <build_root>/pgo/simulation.
+set -euo pipefail
+
+repo=$(cd "$(dirname "$0")/.." && pwd)
+root=${1:-"$repo/build-pgo"}
+repeats=${2:-3}
+scenarios="$repo/scripts/pgo_scenarios.txt"
+profiles="$root/profiles"
+jobs=$(nproc 2>/dev/null || echo 4)
+
+configure_build() {   # dir, extra cmake args...; compiler output goes to <dir>/build.log
+    local dir=$1; shift
+    cmake -S "$repo" -B "$dir" -DCMAKE_BUILD_TYPE=Release "$@" > /dev/null
+    # profiles are not build dependencies, so objects are always rebuilt
+    cmake --build "$dir" --target simulation -j"$jobs" --clean-first > "$dir/build.log" 2>&1 \
+        || { cat "$dir/build.log" >&2; exit 1; }
+}
+
+run_scenarios() {     # binary, output folder
+    local bin=$1 out=$2
+    mkdir -p "$out/waitlist_data"
+    while IFS= read -r line; do
+        [[ -z "$line" || "$line" == \#* ]] && continue
+        # shellcheck disable=SC2086
+        "$bin" --folder "$out/" $line > /dev/null
+    done < "$scenarios"
+}
+
+time_scenarios() {    # binary, output folder -> best wall time of $repeats in seconds
+    local bin=$1 out=$2 best=""
+    for ((i = 0; i < repeats; i++)); do
+        local t0 t1 t
+        t0=$(date +%s.%N)
+        run_scenarios "$bin" "$out"
+        t1=$(date +%s.%N)
+        t=$(awk -v a="$t0" -v b="$t1" 'BEGIN {print b - a}')
+        best=$(awk -v t="$t" -v b="$best" 'BEGIN {print (b == "" || t < b) ? t : b}')
+    done
+    echo "$best"
+}
+
+echo "Building plain Release"
+configure_build "$root/plain"
+
+echo "Building instrumented binary"
+rm -rf "$profiles"
+mkdir -p "$profiles"
+configure_build "$root/pgo-generate" -DSIM_LTO=ON -DSIM_PGO=GENERATE -DSIM_PGO_DIR="$profiles"
+
+echo "Running training scenarios"
+run_scenarios "$root/pgo-generate/simulation" "$root/train-out"
+if ls "$profiles"/*.profraw > /dev/null 2>&1; then   # clang
+    llvm-profdata merge -output="$profiles/simulation.profdata" "$profiles"/*.profraw
+elif ! ls "$profiles"/*.gcda > /dev/null 2>&1; then
+    echo "Training wrote no profile data to $profiles" >&2
+    exit 1
+fi
+
+echo "Building with profile"
+configure_build "$root/pgo" -DSIM_LTO=ON -DSIM_PGO=USE -DSIM_PGO_DIR="$profiles"
+# GCC only warns when an object's profile is missing; such a build is not PGO
+if grep -q "missing-profile" "$root/pgo/build.log"; then
+    grep "missing-profile" "$root/pgo/build.log" >&2
+    echo "The profile-use build did not find the training profile" >&2
+    exit 1
+fi
+
+echo "Timing (best of $repeats)"
+plain=$(time_scenarios "$root/plain/simulation" "$root/bench-out")
+pgo=$(time_scenarios "$root/pgo/simulation" "$root/bench-out")
+awk -v p="$plain" -v g="$pgo" 'BEGIN {printf "plain:    %.2fs\nLTO+PGO:  %.2fs\nspeedup:  %.2fx\n", p, g, p / g}'
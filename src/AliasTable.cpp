@@ -0,0 +1,56 @@
+#include "AliasTable.h"
+
+#include <vector>
+#include <stdexcept>
+
+AliasTable::AliasTable(){}
+
+AliasTable::AliasTable(const std::vector<double> &weights){
+    int n = weights.size();
+    double total = 0;
+    for (double w : weights) {
+        if (w < 0) {throw std::runtime_error("AliasTable weights must be non-negative");}
+        total += w;
+    }
+    if (n == 0 || total <= 0) {
+        throw std::runtime_error("AliasTable needs at least one positive weight");
+    }
+    prob.resize(n);
+    alias.resize(n);
+
+    // Vose's method: pair each under-full column with an over-full one
+    std::vector<double> scaled(n);
+    std::vector<int> small, large;
+    for (int i = 0; i < n; i++) {
+        scaled[i] = weights[i] * n / total;
+        if (scaled[i] < 1) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+    while (small.size() > 0 && large.size() > 0) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        prob[s] = scaled[s];
+        alias[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1;
+        if (scaled[l] < 1) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // leftovers are full columns (up to rounding)
+    for (int i : large) {prob[i] = 1; alias[i] = i;}
+    for (int i : small) {prob[i] = 1; alias[i] = i;}
+}
+
+int AliasTable::sample(std::mt19937 &gen){
+    // one 32-bit draw picks the column and the coin
+    double u = gen() * (1.0 / 4294967296.0) * prob.size();
+    int i = int(u);
+    return (u - i) < prob[i] ? i : alias[i];
+}
+
+int AliasTable::size(){return prob.size();}
@@ -0,0 +1,59 @@
+#include "AppointmentLog.h"
+
+#include <iostream>
+#include <stdexcept>
+#include "arrow/io/file.h"
+#include "parquet/api/writer.h"
+#include "Reader_Writer.h"
+
+AppointmentLog::AppointmentLog(std::string path, int batch_size) : batch_size(batch_size) {
+    PARQUET_ASSIGN_OR_THROW(
+        outfile,
+        arrow::io::FileOutputStream::Open(path));
+    writer = parquet::ParquetFileWriter::Open(outfile, SetupSchema_Appointments(),
+                                            AppointmentWriterProperties());
+    patient_ids.reserve(batch_size);
+    epochs.reserve(batch_size);
+    modalities.reserve(batch_size);
+    outcomes.reserve(batch_size);
+}
+
+AppointmentLog::~AppointmentLog(){
+    try {
+        AppointmentLog::close();
+    } catch (const std::exception &e) {
+        std::cout << "Failed to close appointment log: " << e.what() << std::endl;
+    }
+}
+
+void AppointmentLog::add(int patient_id, int epoch, int modality, int outcome){
+    patient_ids.push_back(patient_id);
+    epochs.push_back(epoch);
+    modalities.push_back(modality);
+    outcomes.push_back(outcome);
+    n_events += 1;
+    if (epochs.size() >= batch_size) {AppointmentLog::flush();}
+}
+
+// one row group per batch, written column by column
+void AppointmentLog::flush(){
+    if (epochs.size() == 0) {return;}
+    int64_t n = epochs.size();
+    parquet::RowGroupWriter *rg = writer->AppendRowGroup();
+    for (auto *column : {&patient_ids, &epochs, &modalities, &outcomes}) {
+        auto *w = static_cast<parquet::Int32Writer*>(rg->NextColumn());
+        w->WriteBatch(n, nullptr, nullptr, column->data());
+        column->clear();
+    }
+    rg->Close();
+}
+
+void AppointmentLog::close(){
+    if (!writer) {return;}
+    AppointmentLog::flush();
+    writer->Close();
+    writer.reset();
+    PARQUET_THROW_NOT_OK(outfile->Close());
+}
+
+long AppointmentLog::get_n_events(){return n_events;}
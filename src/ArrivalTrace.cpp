@@ -0,0 +1,110 @@
+#include "ArrivalTrace.h"
+
+#include <stdexcept>
+
+ArrivalTrace::ArrivalTrace(std::string p, std::vector<int> ps) : path(p), pathways(ps) {
+    std::shared_ptr<arrow::io::MemoryMappedFile> infile;
+    PARQUET_ASSIGN_OR_THROW(
+        infile,
+        arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ));
+    file = parquet::ParquetFileReader::Open(infile);
+
+    epoch_idx = ArrivalTrace::find_column("epoch", true, parquet::Type::INT32, parquet::Type::INT32);
+    pathway_idx = ArrivalTrace::find_column("pathway", true, parquet::Type::INT32, parquet::Type::INT32);
+    age_idx = ArrivalTrace::find_column("age", true, parquet::Type::FLOAT, parquet::Type::DOUBLE);
+    duration_idx = ArrivalTrace::find_column("base_duration", false, parquet::Type::INT32, parquet::Type::INT32);
+    double_age = file->metadata()->schema()->Column(age_idx)->physical_type() == parquet::Type::DOUBLE;
+    ArrivalTrace::read_row();
+}
+
+// index of the named column, -1 if it is optional and absent
+int ArrivalTrace::find_column(std::string name, bool required, parquet::Type::type type,
+                            parquet::Type::type alt_type){
+    const parquet::SchemaDescriptor *schema = file->metadata()->schema();
+    int idx = schema->ColumnIndex(name);
+    if (idx < 0) {
+        if (!required) {return -1;}
+        throw std::runtime_error("Arrival trace needs columns epoch, pathway, age[, base_duration], missing "
+                                + name + ": " + path);
+    }
+    parquet::Type::type actual = schema->Column(idx)->physical_type();
+    if (actual != type && actual != alt_type) {
+        throw std::runtime_error("Arrival trace column " + name + " has the wrong type (epoch, pathway and "
+                                "base_duration are INT32, age FLOAT or DOUBLE): " + path);
+    }
+    return idx;
+}
+
+// column readers of the next non-empty row group; false at the end of the file
+bool ArrivalTrace::next_row_group(){
+    while (row_group + 1 < file->metadata()->num_row_groups()) {
+        row_group += 1;
+        std::shared_ptr<parquet::RowGroupReader> rg = file->RowGroup(row_group);
+        epoch_col = rg->Column(epoch_idx);
+        pathway_col = rg->Column(pathway_idx);
+        age_col = rg->Column(age_idx);
+        duration_col = duration_idx < 0 ? nullptr : rg->Column(duration_idx);
+        if (epoch_col->HasNext()) {return true;}
+    }
+    return false;
+}
+
+// the column's value in the current row; nulls are rejected
+template <typename Reader, typename Value>
+void ArrivalTrace::read_value(parquet::ColumnReader *col, const char *name, Value &value){
+    int16_t def_level;
+    int64_t values_read = 0;
+    static_cast<Reader*>(col)->ReadBatch(1, &def_level, nullptr, &value, &values_read);
+    if (values_read != 1) {
+        throw std::runtime_error("Arrival trace row " + std::to_string(n_rows) + " has no " + name);
+    }
+}
+
+void ArrivalTrace::read_row(){
+    if ((!epoch_col || !epoch_col->HasNext()) && !ArrivalTrace::next_row_group()) {
+        has_pending = false;
+        return;
+    }
+    n_rows += 1;
+    int32_t epoch;
+    int32_t pathway;
+    float age;
+    int32_t duration = 0;
+    ArrivalTrace::read_value<parquet::Int32Reader>(epoch_col.get(), "epoch", epoch);
+    ArrivalTrace::read_value<parquet::Int32Reader>(pathway_col.get(), "pathway", pathway);
+    if (double_age) {
+        double a;
+        ArrivalTrace::read_value<parquet::DoubleReader>(age_col.get(), "age", a);
+        age = a;
+    } else {
+        ArrivalTrace::read_value<parquet::FloatReader>(age_col.get(), "age", age);
+    }
+    if (duration_col) {ArrivalTrace::read_value<parquet::Int32Reader>(duration_col.get(), "base_duration", duration);}
+
+    if (pathway < 0 || pathway >= pathways.size()) {
+        throw std::runtime_error("Arrival trace row " + std::to_string(n_rows) + " has an unknown pathway");
+    }
+    if (has_pending && epoch < pending.arrival_time) {
+        throw std::runtime_error("Arrival trace is not sorted by epoch at row " + std::to_string(n_rows));
+    }
+    if (!duration_col) {duration = pathways[pathway];}
+    pending = WaitlistEntry{epoch, age, (int16_t) pathway, (int16_t) duration, epoch};
+    has_pending = true;
+}
+
+int ArrivalTrace::read_epoch(int epoch, std::vector<WaitlistEntry> &batch){
+    if (has_pending && pending.arrival_time < epoch) {
+        throw std::runtime_error("Arrival trace has rows before epoch " + std::to_string(epoch));
+    }
+    int n = 0;
+    while (has_pending && pending.arrival_time == epoch) {
+        batch.push_back(pending);
+        n += 1;
+        ArrivalTrace::read_row();
+    }
+    return n;
+}
+
+bool ArrivalTrace::exhausted(){return !has_pending;}
+
+long ArrivalTrace::get_n_rows(){return n_rows;}
@@ -0,0 +1,154 @@
+#include "BatchMeans.h"
+
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include "StatUtils.h"
+
+// metric layout: per pathway [wait, sojourn, age_out_rate], then the run-level ones
+namespace {
+    const char *PATHWAY_METRICS[] = {"wait", "sojourn", "age_out_rate"};
+    const char *RUN_METRICS[] = {"utilisation", "group_utilisation", "waitlist_len"};
+    const int N_PATHWAY_METRICS = 3;
+    const int N_RUN_METRICS = 3;
+
+    double lag1_autocorrelation(const std::vector<double> &xs){
+        std::vector<double> ys;
+        for (auto & x : xs) {
+            if (!std::isnan(x)) {ys.push_back(x);}
+        }
+        if (ys.size() < 3) {return 0;}
+        double m = stat_utils::mean(ys);
+        double c0 = 0;
+        double c1 = 0;
+        for (int i = 0; i < ys.size(); i++) {
+            c0 += (ys[i] - m) * (ys[i] - m);
+            if (i > 0) {c1 += (ys[i] - m) * (ys[i - 1] - m);}
+        }
+        return c0 > 0 ? c1 / c0 : 0;
+    }
+}
+
+BatchMeans::BatchMeans(){}
+
+BatchMeans::BatchMeans(int p, int w, int b, int min_b, double a)
+    : n_pathways(p), warmup(w), n_batches(b), min_batches(min_b), alpha(a) {
+    if (min_batches < 2 || n_batches < min_batches) {
+        throw std::runtime_error("Batch means needs 2 <= batch_min <= batch_count");
+    }
+}
+
+int BatchMeans::n_metrics(){return N_PATHWAY_METRICS * n_pathways + N_RUN_METRICS;}
+
+int BatchMeans::get_batch_size(){return batch_size;}
+
+void BatchMeans::merge_pairs(std::vector<std::vector<double>> &xs){
+    for (int i = 0; 2*i + 1 < xs.size(); i++) {
+        for (int m = 0; m < xs[i].size(); m++) {xs[i][m] = xs[2*i][m] + xs[2*i + 1][m];}
+    }
+    xs.resize(xs.size() / 2);
+}
+
+void BatchMeans::add(int epoch, int metric, double x, double n){
+    if (epoch < warmup) {return;}
+    int b = (epoch - warmup) / batch_size;
+    while (b >= 2 * n_batches) {
+        BatchMeans::merge_pairs(num);
+        BatchMeans::merge_pairs(den);
+        batch_size *= 2;
+        b = (epoch - warmup) / batch_size;
+    }
+    while (num.size() <= b) {
+        num.push_back(std::vector<double>(BatchMeans::n_metrics(), 0));
+        den.push_back(std::vector<double>(BatchMeans::n_metrics(), 0));
+    }
+    num[b][metric] += x;
+    den[b][metric] += n;
+    last_epoch = std::max(last_epoch, epoch);
+}
+
+void BatchMeans::add_discharge(int pathway, int epoch, int wait, int sojourn, bool age_out){
+    int base = N_PATHWAY_METRICS * pathway;
+    BatchMeans::add(epoch, base, wait, 1);
+    BatchMeans::add(epoch, base + 1, sojourn, 1);
+    BatchMeans::add(epoch, base + 2, age_out, 1);
+}
+
+void BatchMeans::add_epoch(int epoch, int busy_slots, int slots, int busy_groups, int n_groups,
+                        int waitlist_len){
+    int base = N_PATHWAY_METRICS * n_pathways;
+    BatchMeans::add(epoch, base, busy_slots, slots);
+    BatchMeans::add(epoch, base + 1, busy_groups, n_groups);
+    BatchMeans::add(epoch, base + 2, waitlist_len, 1);
+}
+
+// means of the first `batches` complete batches of `size` epochs, NaN where a batch has no data
+std::vector<double> BatchMeans::batch_means(int metric, int batches, int size){
+    int k = size / batch_size;
+    std::vector<double> means;
+    for (int b = 0; b < batches; b++) {
+        double x = 0;
+        double n = 0;
+        for (int j = b*k; j < (b + 1)*k && j < num.size(); j++) {
+            x += num[j][metric];
+            n += den[j][metric];
+        }
+        means.push_back(n > 0 ? x / n : NAN);
+    }
+    return means;
+}
+
+std::vector<BatchMeansEstimate> BatchMeans::estimates(double confidence){
+    std::vector<BatchMeansEstimate> out;
+    if (last_epoch < 0) {return out;}
+    // a trailing partial batch is dropped
+    int observed = last_epoch - warmup + 1;
+    int size = batch_size;
+    int batches = observed / size;
+    double z = stat_utils::normal_quantile(1 - alpha);
+
+    // double the batch size while any metric's batch means are still correlated
+    auto correlated = [&](int m, int b, int s) {
+        return lag1_autocorrelation(BatchMeans::batch_means(m, b, s)) > z / std::sqrt(double(b));
+    };
+    while (batches / 2 >= min_batches) {
+        bool any = false;
+        for (int m = 0; m < BatchMeans::n_metrics() && !any; m++) {any = correlated(m, batches, size);}
+        if (!any) {break;}
+        size *= 2;
+        batches = observed / size;
+    }
+
+    for (int m = 0; m < BatchMeans::n_metrics(); m++) {
+        std::vector<double> means = BatchMeans::batch_means(m, batches, size);
+        ConfidenceInterval ci = stat_utils::mean_ci(means, confidence);
+        if (ci.n == 0) {continue;}  // e.g. no group servers
+        BatchMeansEstimate e;
+        if (m < N_PATHWAY_METRICS * n_pathways) {
+            e.metric = PATHWAY_METRICS[m % N_PATHWAY_METRICS];
+            e.pathway = m / N_PATHWAY_METRICS;
+        } else {
+            e.metric = RUN_METRICS[m - N_PATHWAY_METRICS * n_pathways];
+            e.pathway = -1;
+        }
+        e.mean = ci.mean;
+        e.lower = ci.lower;
+        e.upper = ci.upper;
+        e.n_batches = ci.n;
+        e.batch_size = size;
+        e.lag1 = lag1_autocorrelation(means);
+        e.correlated = batches > 0 && e.lag1 > z / std::sqrt(double(batches));
+        out.push_back(e);
+    }
+    return out;
+}
+
+void BatchMeans::write_csv(std::string path, const std::vector<BatchMeansEstimate> &estimates){
+    std::ofstream out(path);
+    if (!out) {throw std::runtime_error("Could not write batch means to " + path);}
+    out << "metric,pathway,mean,ci_lower,ci_upper,n_batches,batch_size,lag1,correlated\n";
+    for (auto & e : estimates) {
+        out << e.metric << "," << e.pathway << "," << e.mean << "," << e.lower << "," << e.upper << ","
+            << e.n_batches << "," << e.batch_size << "," << e.lag1 << "," << e.correlated << "\n";
+    }
+}
@@ -0,0 +1,155 @@
+#include "CapacitySearch.h"
+
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include "Replication.h"
+#include "RunStatistics.h"
+#include "StatUtils.h"
+#include "WriteCSV.h"
+
+CapacitySearch::CapacitySearch(SimConfig cfg, std::string metric, double threshold,
+                            double quantile, int min_reps, int max_reps,
+                            double confidence, float start_utilization) : cfg(cfg), metric(metric),
+                            threshold(threshold), quantile(quantile), min_reps(min_reps),
+                            max_reps(max_reps), confidence(confidence),
+                            start_utilization(start_utilization) {
+    if (metric != "wait_quantile" && metric != "age_out_rate") {
+        throw std::runtime_error("Unknown search metric: " + metric);
+    }
+    if (min_reps < 2 || max_reps < min_reps) {
+        throw std::runtime_error("Capacity search needs 2 <= min_reps <= max_reps");
+    }
+}
+
+double CapacitySearch::get_metric(const RunStatistics &stats, int p){
+    if (p >= stats.n_pathways()) {return std::nan("");}
+    const PathwayStatistics &ps = stats.pathway(p);
+    if (metric == "wait_quantile") {
+        return ps.wait.quantile(quantile);
+    }
+    return ps.age_out_rate();
+}
+
+// feasible if all pathways' intervals lie below the threshold, infeasible
+// as soon as one pathway's interval lies above it
+void CapacitySearch::classify(Evaluation &ev){
+    bool all_below = true;
+    ev.cis.clear();
+    for (auto & samples : ev.samples) {
+        ConfidenceInterval ci = stat_utils::mean_ci(samples, confidence);
+        ev.cis.push_back(ci);
+        if (ci.n == 0) {continue;}  // pathway never discharged anyone
+        if (ci.lower > threshold) {
+            ev.verdict = 0;
+            ev.decided = true;
+            return;
+        }
+        if (ci.upper > threshold) {all_below = false;}
+    }
+    ev.verdict = all_below ? 1 : -1;
+    ev.decided = all_below;
+}
+
+CapacitySearch::Evaluation& CapacitySearch::evaluate(int n_servers){
+    auto it = evaluations.find(n_servers);
+    if (it != evaluations.end()) {return it->second;}
+
+    Evaluation &ev = evaluations[n_servers];
+    ev.n_servers = n_servers;
+    ev.samples.resize(cfg.pathways.size());
+    SimConfig trial = cfg;
+    trial.n_servers = n_servers;
+    for (int rep = 0; rep < max_reps; rep++) {
+        // rep doubles as the run index -> same seeds for every candidate
+        RunStatistics stats = run_replication(trial, rep);
+        epochs_simulated += stats.epochs_run;
+        for (int p = 0; p < ev.samples.size(); p++) {
+            ev.samples[p].push_back(get_metric(stats, p));
+        }
+        if (!stats.stable) {    // stopped early as diverging (--stability_check)
+            ev.verdict = 0;
+            ev.decided = true;
+            break;
+        }
+        if (rep + 1 >= min_reps) {
+            CapacitySearch::classify(ev);
+            if (ev.decided) {break;}
+        }
+    }
+    if (!ev.decided && ev.verdict != 0) {
+        // fall back to the point estimate
+        ev.verdict = 1;
+        for (auto & ci : ev.cis) {
+            if (ci.n > 0 && ci.mean > threshold) {ev.verdict = 0;}
+        }
+    }
+    std::cout << "Servers: " << n_servers << " reps: " << ev.samples[0].size()
+                << (ev.verdict == 1 ? " feasible" : " infeasible")
+                << (ev.decided ? "" : " (undecided at max reps)") << std::endl;
+    return ev;
+}
+
+bool CapacitySearch::is_feasible(int n_servers){
+    return CapacitySearch::evaluate(n_servers).verdict == 1;
+}
+
+int CapacitySearch::run(){
+    // bracket seeded from the offered load
+    int hi = std::max(1, utilization_to_servers(start_utilization, cfg.pathways, cfg.probs, cfg.arr_lam));
+    int lo = -1;
+    int n_doublings = 0;
+    while (!CapacitySearch::is_feasible(hi)) {
+        lo = hi;
+        hi *= 2;
+        n_doublings += 1;
+        if (n_doublings > 8) {
+            throw std::runtime_error("Capacity search could not find a feasible server count");
+        }
+    }
+    if (lo < 0) {
+        lo = std::min(hi - 1, utilization_to_servers(1.0, cfg.pathways, cfg.probs, cfg.arr_lam));
+        while (lo > 0 && CapacitySearch::is_feasible(lo)) {
+            hi = lo;
+            lo = lo / 2;
+        }
+        if (lo == 0 && CapacitySearch::is_feasible(0)) {hi = 0;}
+    }
+    // bisect: lo infeasible, hi feasible
+    while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        if (CapacitySearch::is_feasible(mid)) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    result = hi;
+    std::cout << "Minimum feasible servers: " << result << " (" << evaluations.size()
+                << " candidates, " << epochs_simulated << " epochs simulated)" << std::endl;
+    return result;
+}
+
+void CapacitySearch::write_results(std::string path){
+    if (result < 0) {
+        throw std::runtime_error("Capacity search has not been run");
+    }
+    Evaluation &ev = evaluations.at(result);
+    std::vector<std::pair<std::string, double>> dataset;
+    dataset.push_back({"n_servers", double(result)});
+    for (int p = 0; p < cfg.n_group_servers.size(); p++) {
+        dataset.push_back({"n_group_servers_" + std::to_string(p), double(cfg.n_group_servers[p])});
+    }
+    dataset.push_back({"threshold", threshold});
+    dataset.push_back({"reps", double(ev.samples[0].size())});
+    dataset.push_back({"decided", double(ev.decided)});
+    for (int p = 0; p < ev.cis.size(); p++) {
+        std::string sfx = "_" + std::to_string(p);
+        dataset.push_back({metric + "_mean" + sfx, ev.cis[p].mean});
+        dataset.push_back({metric + "_lower" + sfx, ev.cis[p].lower});
+        dataset.push_back({metric + "_upper" + sfx, ev.cis[p].upper});
+    }
+    dataset.push_back({"n_candidates", double(evaluations.size())});
+    dataset.push_back({"epochs_simulated", double(epochs_simulated)});
+    write_csv(path, dataset);
+}
@@ -0,0 +1,127 @@
+#include "ClassSelector.h"
+
+#include <stdexcept>
+#include "Invariants.h"
+
+ClassSelector::ClassSelector(){}
+
+ClassSelector::ClassSelector(Policy p, int n_classes, std::vector<double> w) : policy(p) {
+    if (w.empty()) {w.assign(n_classes, 1.0);}
+    if (w.size() != n_classes) {
+        throw std::runtime_error("fair_weights needs one weight per pathway");
+    }
+    for (auto & x : w) {
+        if (!(x > 0)) {throw std::runtime_error("fair_weights must be positive");}
+    }
+    weights = w;
+    pos.assign(n_classes, -1);
+    keys.assign(n_classes, 0);
+    served.assign(n_classes, 0);
+    heap.reserve(n_classes);
+}
+
+bool ClassSelector::is_indexed(const std::string &name){
+    return name == "lwf" || name == "age" || name == "fair";
+}
+
+ClassSelector::Policy ClassSelector::parse(const std::string &name){
+    if (name == "lwf") {return LONGEST_WAIT;}
+    if (name == "age") {return AGE_URGENCY;}
+    if (name == "fair") {return WEIGHTED_FAIR;}
+    throw std::runtime_error("Unknown waitlist policy: " + name);
+}
+
+// keys only depend on the head entry (and admissions for WEIGHTED_FAIR), never
+// on the current epoch, so they stay valid until the head changes
+double ClassSelector::key_of(int c, const WaitlistEntry &head) const {
+    switch (policy) {
+        case LONGEST_WAIT:
+            return head.arrival_time;   // earliest arrival has waited longest
+        case AGE_URGENCY:
+            // head age at epoch t is arrival_age + (t - arrival_time)/52; the
+            // oldest head is the one closest to max_ax_age whatever t is
+            return -(double(head.arrival_age) - double(head.arrival_time)/52);
+        case WEIGHTED_FAIR:
+            return double(served[c]) / weights[c];
+    }
+    return 0;
+}
+
+// ties go to the lower class id so selection is deterministic
+bool ClassSelector::before(int a, int b) const {
+    if (keys[a] != keys[b]) {return keys[a] < keys[b];}
+    return a < b;
+}
+
+void ClassSelector::swap_nodes(int i, int j){
+    std::swap(heap[i], heap[j]);
+    pos[heap[i]] = i;
+    pos[heap[j]] = j;
+}
+
+void ClassSelector::sift_up(int i){
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!before(heap[i], heap[parent])) {break;}
+        ClassSelector::swap_nodes(i, parent);
+        i = parent;
+    }
+}
+
+void ClassSelector::sift_down(int i){
+    int n = heap.size();
+    while (true) {
+        int best = i;
+        int l = 2*i + 1;
+        int r = l + 1;
+        if (l < n && before(heap[l], heap[best])) {best = l;}
+        if (r < n && before(heap[r], heap[best])) {best = r;}
+        if (best == i) {break;}
+        ClassSelector::swap_nodes(i, best);
+        i = best;
+    }
+}
+
+void ClassSelector::remove(int c){
+    int i = pos[c];
+    if (i < 0) {return;}
+    int last = heap.size() - 1;
+    ClassSelector::swap_nodes(i, last);
+    heap.pop_back();
+    pos[c] = -1;
+    if (i < heap.size()) {
+        int moved = heap[i];
+        ClassSelector::sift_up(i);
+        ClassSelector::sift_down(pos[moved]);
+    }
+}
+
+void ClassSelector::on_head_changed(int c, const WaitlistEntry *head){
+    if (head == nullptr) {
+        ClassSelector::remove(c);
+        return;
+    }
+    keys[c] = ClassSelector::key_of(c, *head);
+    if (pos[c] < 0) {
+        pos[c] = heap.size();
+        heap.push_back(c);
+    }
+    ClassSelector::sift_up(pos[c]);
+    ClassSelector::sift_down(pos[c]);
+}
+
+void ClassSelector::on_admit(int c){served[c] += 1;}
+
+int ClassSelector::top() const {return heap.empty() ? -1 : heap[0];}
+
+bool ClassSelector::empty() const {return heap.empty();}
+
+void ClassSelector::check_invariants(uint64_t nonempty_mask) const {
+    for (int c = 0; c < pos.size(); c++) {
+        SIM_INVARIANT((pos[c] >= 0) == bool(nonempty_mask >> c & 1), "class heap out of sync with waitlist");
+    }
+    for (int i = 0; i < heap.size(); i++) {
+        SIM_INVARIANT(pos[heap[i]] == i, "class heap index out of sync");
+        SIM_INVARIANT(i == 0 || !before(heap[i], heap[(i - 1) / 2]), "class heap order violated");
+    }
+}
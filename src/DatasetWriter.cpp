@@ -0,0 +1,222 @@
+#include "DatasetWriter.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <sstream>
+#include <map>
+#include <algorithm>
+
+#include "arrow/io/file.h"
+#include "parquet/api/reader.h"
+#include "parquet/api/writer.h"
+#include "parquet/stream_writer.h"
+#include "Reader_Writer.h"
+#include "DischargeList.h"
+
+DatasetWriter::DatasetWriter(std::string root, int scenario_id, int n_pathways, int runs_per_file,
+                            int n_runs) :
+                            root(root), scenario_id(scenario_id), n_pathways(n_pathways),
+                            runs_per_file(runs_per_file), n_runs(n_runs) {
+    if (runs_per_file < 1) {
+        throw std::runtime_error("runs_per_file must be at least 1");
+    }
+    outfiles.resize(n_pathways);
+    writers.resize(n_pathways);
+    open_files.resize(n_pathways, -1);
+}
+
+DatasetWriter::~DatasetWriter(){
+    if (!closed) {
+        try {
+            DatasetWriter::close();
+        } catch (const std::exception &e) {
+            std::cout << "Failed to close dataset: " << e.what() << std::endl;
+        }
+    }
+}
+
+void DatasetWriter::set_part(int p){
+    part = p;
+    suffix = "_" + std::to_string(p);
+}
+
+void DatasetWriter::begin_run(int r){
+    run = r;
+    int b = r / runs_per_file;
+    if (b != block) {
+        DatasetWriter::close_block();
+        block = b;
+        DatasetWriter::open_block(b * runs_per_file);
+    }
+    for (int p = 0; p < n_pathways; p++) {
+        files[open_files[p]].last_run = r;
+    }
+}
+
+// a file holding several runs is labelled with the block's run range, so
+// pruning on a run= key can never skip rows of the other runs in the file
+std::string DatasetWriter::run_partition(int first_run){
+    if (runs_per_file == 1) {return "run=" + std::to_string(first_run);}
+    int last_run = std::min(first_run + runs_per_file, n_runs) - 1;    // the last block may be short
+    return "runs=" + std::to_string(first_run) + "-" + std::to_string(last_run);
+}
+
+void DatasetWriter::open_block(int first_run){
+    for (int p = 0; p < n_pathways; p++) {
+        std::string scenario_dir = root + "scenario=" + std::to_string(scenario_id) + "/";
+        std::string dir = DatasetWriter::run_partition(first_run) + "/pathway=" + std::to_string(p);
+        std::filesystem::create_directories(scenario_dir + dir);
+        PartitionFile file;
+        file.rel_path = dir + "/part-" + std::to_string(part) + ".parquet";
+        file.scenario = scenario_id;
+        file.pathway = p;
+        file.first_run = run;
+        file.last_run = run;
+        PARQUET_ASSIGN_OR_THROW(
+            outfiles[p],
+            arrow::io::FileOutputStream::Open(scenario_dir + file.rel_path));
+        writers[p] = parquet::StreamWriter(parquet::ParquetFileWriter::Open(outfiles[p], SetupSchema_Compact(),
+                                                                            CompactWriterProperties()));
+        writers[p].SetMaxRowGroupSize(64 << 20);
+        open_files[p] = files.size();
+        files.push_back(file);
+    }
+}
+
+void DatasetWriter::close_block(){
+    if (block < 0) {return;}
+    for (int p = 0; p < n_pathways; p++) {
+        writers[p] = parquet::StreamWriter();   // flushes the footer
+        PARQUET_THROW_NOT_OK(outfiles[p]->Close());
+        outfiles[p].reset();
+        open_files[p] = -1;
+    }
+    block = -1;
+}
+
+void DatasetWriter::write(const DischargeRecord &record){
+    if (record.pathway < 0 || record.pathway >= n_pathways) {
+        throw std::runtime_error("Pathway out of range for dataset output");
+    }
+    record.write_compact(writers[record.pathway], scenario_id, run);
+    writers[record.pathway] << parquet::EndRow;
+    files[open_files[record.pathway]].n_rows += 1;
+}
+
+void DatasetWriter::close(){
+    DatasetWriter::close_block();
+    if (files.size() > 0) {
+        DatasetWriter::write_summary(root + "scenario=" + std::to_string(scenario_id) + "/",
+                                    files, "", suffix);
+    }
+    closed = true;
+}
+
+// _metadata: all row-group footers with their relative file paths, in the
+// layout Arrow/Dask use to plan reads without opening every file.
+// _manifest.csv: one line per file for tools that only glob.
+void DatasetWriter::write_summary(std::string dir, const std::vector<PartitionFile> &files,
+                                std::string path_prefix, std::string suffix){
+    std::shared_ptr<parquet::FileMetaData> summary;
+    for (auto & file : files) {
+        std::string rel_path = path_prefix + file.rel_path;
+        std::shared_ptr<arrow::io::ReadableFile> infile;
+        PARQUET_ASSIGN_OR_THROW(infile, arrow::io::ReadableFile::Open(dir + rel_path));
+        std::shared_ptr<parquet::FileMetaData> md = parquet::ReadMetaData(infile);
+        md->set_file_path(rel_path);
+        if (summary) {
+            summary->AppendRowGroups(*md);
+        } else {
+            summary = md;
+        }
+        PARQUET_THROW_NOT_OK(infile->Close());
+    }
+    if (summary) {
+        std::shared_ptr<arrow::io::FileOutputStream> sink;
+        PARQUET_ASSIGN_OR_THROW(sink, arrow::io::FileOutputStream::Open(dir + "_metadata" + suffix));
+        parquet::WriteMetaDataFile(*summary, sink.get());
+        PARQUET_THROW_NOT_OK(sink->Close());
+    }
+
+    std::ofstream manifest(dir + "_manifest" + suffix + ".csv");
+    manifest << "file,scenario,pathway,first_run,last_run,n_rows\n";
+    for (auto & file : files) {
+        manifest << path_prefix + file.rel_path << "," << file.scenario << "," << file.pathway << ","
+                << file.first_run << "," << file.last_run << "," << file.n_rows << "\n";
+    }
+    manifest.close();
+}
+
+std::vector<DatasetWriter::PartitionFile> DatasetWriter::read_manifest(std::string path){
+    std::vector<PartitionFile> files;
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);     // header
+    while (std::getline(in, line)) {
+        if (line.empty()) {continue;}
+        std::stringstream ss(line);
+        std::string field;
+        PartitionFile file;
+        std::getline(ss, file.rel_path, ',');
+        std::getline(ss, field, ',');
+        file.scenario = std::stoi(field);
+        std::getline(ss, field, ',');
+        file.pathway = std::stoi(field);
+        std::getline(ss, field, ',');
+        file.first_run = std::stoi(field);
+        std::getline(ss, field, ',');
+        file.last_run = std::stoi(field);
+        std::getline(ss, field, ',');
+        file.n_rows = std::stol(field);
+        files.push_back(file);
+    }
+    return files;
+}
+
+// folds every scenario's shard manifests into one _metadata/_manifest.csv and
+// writes dataset-wide ones at the root covering all scenarios
+void DatasetWriter::consolidate(std::string root){
+    namespace fs = std::filesystem;
+    if (!fs::is_directory(root)) {return;}
+    std::vector<PartitionFile> all_files;
+    std::vector<std::string> scenario_dirs;
+    for (auto & entry : fs::directory_iterator(root)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_directory() && name.rfind("scenario=", 0) == 0) {scenario_dirs.push_back(name);}
+    }
+    std::sort(scenario_dirs.begin(), scenario_dirs.end());
+    for (auto & name : scenario_dirs) {
+        std::string dir = root + name + "/";
+        std::map<std::string, PartitionFile> by_path;   // shards may be copied in more than once
+        std::vector<fs::path> shard_files;
+        for (auto & entry : fs::directory_iterator(dir)) {
+            std::string fname = entry.path().filename().string();
+            if (fname.rfind("_manifest", 0) == 0) {
+                for (auto & file : DatasetWriter::read_manifest(entry.path().string())) {
+                    by_path[file.rel_path] = file;
+                }
+            }
+            if (fname.rfind("_manifest_", 0) == 0 || fname.rfind("_metadata_", 0) == 0) {
+                shard_files.push_back(entry.path());
+            }
+        }
+        std::vector<PartitionFile> files;
+        for (auto & kv : by_path) {files.push_back(kv.second);}
+        DatasetWriter::write_summary(dir, files, "", "");
+        for (auto & path : shard_files) {fs::remove(path);}
+        for (auto & file : files) {
+            all_files.push_back(file);
+        }
+    }
+    // root-level files address partitions through their scenario directory
+    std::vector<PartitionFile> prefixed;
+    for (auto & file : all_files) {
+        PartitionFile f = file;
+        f.rel_path = "scenario=" + std::to_string(f.scenario) + "/" + f.rel_path;
+        prefixed.push_back(f);
+    }
+    DatasetWriter::write_summary(root, prefixed, "", "");
+    std::cout << "Consolidated " << all_files.size() << " dataset files under " << root << std::endl;
+}
@@ -2,17 +2,46 @@
 
 #include <vector>
 #include <iostream>
+#include <stdexcept>
+#include <algorithm>
 #include "Patient.h"
 
 #include "arrow/io/file.h"
 #include "parquet/stream_writer.h" 
 #include "Reader_Writer.h"
+#include "Invariants.h"
+
+DischargeRecord DischargeRecord::from_patient(Patient &patient){
+    return DischargeRecord{patient.get_id(), patient.get_pathway(), patient.get_base_duration(), patient.get_arrival_t(),
+                            patient.get_arrival_age(), patient.get_first_appt(), patient.get_n_appts(),
+                            patient.get_discharge_time(), patient.get_n_ext(), patient.get_total_wait_time(),
+                            patient.get_discharge_duration(), patient.get_modality_sum(), patient.get_age_out()};
+}
+
+// same row an unadmitted Patient would produce
+DischargeRecord DischargeRecord::from_aged_out(const WaitlistEntry &entry, int epoch){
+    return DischargeRecord{-1, entry.pathway, entry.base_duration, entry.arrival_time,
+                            entry.arrival_age, -1, 0,
+                            epoch, 0, 0,
+                            0, 0, 1};
+}
+
+// column order and types follow SetupSchema_Compact; the caller ends the row
+void DischargeRecord::write_compact(parquet::StreamWriter &os, int scenario_id, int run_id) const {
+    os << int32_t(scenario_id) << int32_t(run_id) << int32_t(patient_id)
+        << int8_t(pathway) << int16_t(base_duration) << int32_t(arrival_t)
+        << arrival_age << int32_t(first_appt) << int16_t(n_appts)
+        << int32_t(discharge_t) << int8_t(n_ext) << int32_t(total_wait_time)
+        << int16_t(discharge_duration) << int16_t(modality_sum) << bool(age_out);
+}
 
 DischargeList::DischargeList(){
     discharge_list = std::vector<Patient>();
 }
 
-DischargeList::DischargeList(std::string p){
+DischargeList::DischargeList(std::string p) : DischargeList(p, OutputOptions()) {}
+
+DischargeList::DischargeList(std::string p, OutputOptions opts) : options(opts) {
     discharge_list = std::vector<Patient>();
     DischargeList::set_path(p);
 
@@ -25,35 +54,131 @@ DischargeList::DischargeList(std::string p){
         outfile,
         arrow::io::FileOutputStream::Open(path));
 
-    std::shared_ptr<parquet::schema::GroupNode> schema = SetupSchema();
-    
-    parquet::WriterProperties::Builder builder;
-    builder.compression(parquet::Compression::GZIP);
+    bool sampled = options.sample_size > 0;
+    if (sampled) {sampler = std::make_unique<DischargeSampler>(options.sample_size, options.sample_seed);}
+    if (options.compact) {
+        os = parquet::StreamWriter(parquet::ParquetFileWriter::Open(outfile, SetupSchema_Compact(sampled),
+                                                                    CompactWriterProperties()));
+        os.SetMaxRowGroupSize(64 << 20);   // several discharge_t-sorted row groups per large file
+    } else {
+        std::shared_ptr<parquet::schema::GroupNode> schema = SetupSchema(sampled);
+
+        parquet::WriterProperties::Builder builder;
+        builder.compression(parquet::Compression::GZIP);
+
+        os = parquet::StreamWriter(parquet::ParquetFileWriter::Open(outfile, schema, builder.build()));
+    }
+    streaming = true;
+}
 
-    os = parquet::StreamWriter(parquet::ParquetFileWriter::Open(outfile, schema, builder.build()));
+DischargeList::DischargeList(OutputOptions opts) : options(opts) {
+    if (options.dataset == nullptr) {
+        throw std::runtime_error("DischargeList needs an output path or dataset");
+    }
+    discharge_list = std::vector<Patient>();
+    streaming = true;
 }
 
 void DischargeList::add_patient(Patient patient){
     n_patients += 1;
+    stats.add_patient(patient);
+    if (batch_means) {
+        batch_means->add_discharge(patient.get_pathway(), patient.get_discharge_time(), patient.get_total_wait_time(),
+                                patient.get_sojourn_time(), patient.get_age_out() == 1);
+    }
+    if (invariants::enabled()) {DischargeList::check_record(DischargeRecord::from_patient(patient));}
+    if (!streaming) {return;}
     // discharge_list.push_back(patient);
-    // std::cout << "Writing patient to parquet" << std::endl;
-    os << (patient.get_pathway()) << (patient.get_base_duration()) << (patient.get_arrival_t()) 
-        << (patient.get_arrival_age()) << (patient.get_first_appt())
-        << (patient.get_n_appts()) << (patient.get_discharge_time()) << (patient.get_n_ext())
-        << (patient.get_sojourn_time()) << (patient.get_total_wait_time()) << (patient.get_discharge_duration())
-        << (patient.get_modality_sum())
-        << (patient.get_pct_face()) << (patient.get_age_out()) << (patient.get_age(patient.get_discharge_time())) << parquet::EndRow;
-    // std::cout << "Patient written to parquet" << std::endl;
+    if (sampler) {
+        sampler->offer(DischargeRecord::from_patient(patient));
+        return;
+    }
+    DischargeList::write_record(DischargeRecord::from_patient(patient));
+}
+
+void DischargeList::add_aged_out(const WaitlistEntry &entry, int epoch){
+    n_patients += 1;
+    stats.add_aged_out(entry, epoch);
+    if (batch_means) {
+        batch_means->add_discharge(entry.pathway, epoch, epoch - entry.arrival_time, epoch - entry.arrival_time, true);
+    }
+    if (invariants::enabled()) {DischargeList::check_record(DischargeRecord::from_aged_out(entry, epoch));}
+    if (!streaming) {return;}
+    if (sampler) {
+        sampler->offer(DischargeRecord::from_aged_out(entry, epoch));
+        return;
+    }
+    DischargeList::write_record(DischargeRecord::from_aged_out(entry, epoch));
+}
+
+void DischargeList::check_record(const DischargeRecord &r){
+    SIM_INVARIANT(r.discharge_t >= r.arrival_t, "discharged before arrival");
+    SIM_INVARIANT(r.n_appts >= 0 && r.modality_sum <= r.n_appts, "appointment counts inconsistent");
+    SIM_INVARIANT(r.n_appts == 0 ? r.first_appt == -1 : r.first_appt >= r.arrival_t,
+                "first appointment before arrival");
+    SIM_INVARIANT(r.total_wait_time >= 0, "negative wait");
+}
+
+void DischargeList::write_record(const DischargeRecord &r, double sample_weight){
+    if (options.dataset != nullptr) {
+        options.dataset->write(r);
+        return;
+    }
+    if (options.compact) {
+        r.write_compact(os, options.scenario_id, options.run_id);
+    } else {
+        float pct_face = r.n_appts == 0 ? 0.0f : float(r.modality_sum)/float(r.n_appts);
+        float age = double(r.arrival_age) + float(r.discharge_t - r.arrival_t)/52;
+        os << r.pathway << r.base_duration << r.arrival_t
+            << r.arrival_age << r.first_appt
+            << r.n_appts << r.discharge_t << r.n_ext
+            << (r.discharge_t - r.arrival_t) << r.total_wait_time << r.discharge_duration
+            << r.modality_sum
+            << pct_face << r.age_out << age;
+    }
+    if (sampler) {os << sample_weight;}
+    os << parquet::EndRow;
+}
+
+// sampled rows in discharge order, as a full output would have them
+void DischargeList::write_sample(){
+    if (!sampler) {return;}
+    std::vector<std::pair<const DischargeRecord*, double>> rows;
+    long n_seen = 0;
+    for (int s = 0; s < sampler->get_n_strata(); s++) {
+        for (auto & record : sampler->get_sample(s)) {rows.push_back({&record, sampler->get_weight(s)});}
+        n_seen += sampler->get_n_seen(s);
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const auto &a, const auto &b){
+        return a.first->discharge_t < b.first->discharge_t;
+    });
+    for (auto & row : rows) {DischargeList::write_record(*row.first, row.second);}
+    std::cout << "Sampled " << rows.size() << " of " << n_seen << " discharges" << std::endl;
+    sampler.reset();
+}
+
+void DischargeList::add_appointment(Patient &patient, int epoch){
+    if (!appointment_log) {return;}
+    appointment_log->add(patient.get_id(), epoch, patient.get_last_modality(), patient.get_last_outcome());
 }
 
 int DischargeList::get_n_patients(){return n_patients;}
 
+void DischargeList::copy_statistics(const DischargeList &other){
+    n_patients = other.n_patients;
+    stats = other.stats;
+}
+
 int DischargeList::size(){
     return discharge_list.size();
 }
 
 // setter methods
 void DischargeList::set_path(std::string p){path = p;}
+void DischargeList::set_warmup(int w){stats.set_warmup(w);}
+void DischargeList::set_appointment_log(std::string p){appointment_log = std::make_unique<AppointmentLog>(p);}
+void DischargeList::set_batch_means(BatchMeans *b){batch_means = b;}
 
 // getter methods
-std::vector<Patient> DischargeList::get_discharge_list(){return discharge_list;}
\ No newline at end of file
+std::vector<Patient> DischargeList::get_discharge_list(){return discharge_list;}
+RunStatistics& DischargeList::get_statistics(){return stats;}
@@ -0,0 +1,56 @@
+#include "DischargeSampler.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "DischargeList.h"
+
+DischargeSampler::DischargeSampler(int capacity, unsigned int seed) : capacity(capacity), rng(seed) {
+    if (capacity < 1) {
+        throw std::runtime_error("Discharge sample size must be positive");
+    }
+}
+
+DischargeSampler::~DischargeSampler() = default;
+
+int DischargeSampler::stratum(int pathway, bool aged_out){return 2 * pathway + (aged_out ? 1 : 0);}
+
+void DischargeSampler::offer(const DischargeRecord &record){
+    int s = DischargeSampler::stratum(record.pathway, record.age_out == 1);
+    if (s >= reservoirs.size()) {reservoirs.resize(s + 1);}
+    Reservoir &r = reservoirs[s];
+    r.n_seen += 1;
+    if (r.sample.size() < capacity) {
+        r.sample.push_back(record);
+        if (r.sample.size() == capacity) {
+            r.w = std::exp(std::log(DischargeSampler::uniform()) / capacity);
+            DischargeSampler::schedule(r);
+        }
+        return;
+    }
+    if (r.n_seen < r.next) {return;}
+    r.sample[std::uniform_int_distribution<int>(0, capacity - 1)(rng)] = record;
+    r.w *= std::exp(std::log(DischargeSampler::uniform()) / capacity);
+    DischargeSampler::schedule(r);
+}
+
+// geometric skip with success probability w
+void DischargeSampler::schedule(Reservoir &r){
+    double skip = std::floor(std::log(DischargeSampler::uniform()) / std::log1p(-r.w));
+    double limit = double(std::numeric_limits<long>::max() / 2);
+    if (!(skip < limit)) {skip = limit;}    // w underflowed: nothing more will be kept
+    r.next = r.n_seen + 1 + long(skip);
+}
+
+double DischargeSampler::uniform(){return 1.0 - unif(rng);}
+
+int DischargeSampler::get_n_strata(){return reservoirs.size();}
+
+const std::vector<DischargeRecord>& DischargeSampler::get_sample(int s){return reservoirs[s].sample;}
+
+long DischargeSampler::get_n_seen(int s){return reservoirs[s].n_seen;}
+
+double DischargeSampler::get_weight(int s){
+    if (reservoirs[s].sample.empty()) {return 0;}
+    return double(reservoirs[s].n_seen) / reservoirs[s].sample.size();
+}
@@ -0,0 +1,157 @@
+#include "DischargeScanner.h"
+
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include "parquet/api/reader.h"
+#include "RunStatistics.h"
+
+namespace {
+    // discharge columns read by the scanner, in the order of the buffers below
+    const std::vector<std::string> int_columns = {"class", "arrival_t", "first_appt", "n_appts",
+                                                "discharge_t", "total_wait_time", "modality_sum"};
+    enum {CLASS, ARRIVAL_T, FIRST_APPT, N_APPTS, DISCHARGE_T, WAIT, MODALITY_SUM, N_INT_COLUMNS};
+
+    // run index from "simulation_data_<run>.parquet", -1 otherwise
+    int run_from_name(const std::string &name){
+        const std::string prefix = "simulation_data_";
+        if (name.rfind(prefix, 0) != 0) {return -1;}
+        try {
+            return std::stoi(name.substr(prefix.size()));
+        } catch (const std::logic_error &e) {
+            return -1;
+        }
+    }
+
+    // flat simulation_data_<run>.parquet files, or parts of the hive dataset
+    // under discharges/; appointment, utilisation and waitlist logs are skipped
+    bool is_discharge_file(const std::filesystem::path &root, const std::filesystem::path &path){
+        if (path.filename().string().rfind("simulation_data_", 0) == 0) {return true;}
+        if (root.filename() == "discharges") {return true;}
+        std::filesystem::path rel = path.lexically_relative(root);
+        return !rel.empty() && *rel.begin() == "discharges";
+    }
+
+    // reads n values of a required INT32-backed (any integer width) or BOOLEAN
+    // column, fewer only at the end of the column chunk. ReadBatch stops at data
+    // page boundaries, which fall on different rows in every column.
+    int64_t read_batch(parquet::ColumnReader *reader, int64_t n, std::vector<int32_t> &out){
+        int64_t total = 0;
+        out.resize(n);
+        if (reader->descr()->physical_type() == parquet::Type::BOOLEAN) {
+            std::vector<uint8_t> buf(n);
+            auto *r = static_cast<parquet::BoolReader*>(reader);
+            while (total < n && r->HasNext()) {
+                int64_t values_read = 0;
+                r->ReadBatch(n - total, nullptr, nullptr, reinterpret_cast<bool*>(buf.data()) + total, &values_read);
+                total += values_read;
+            }
+            for (int64_t i = 0; i < total; i++) {out[i] = buf[i];}
+        } else {
+            auto *r = static_cast<parquet::Int32Reader*>(reader);
+            while (total < n && r->HasNext()) {
+                int64_t values_read = 0;
+                r->ReadBatch(n - total, nullptr, nullptr, out.data() + total, &values_read);
+                total += values_read;
+            }
+        }
+        return total;
+    }
+
+    // a column that ends before the first one means a malformed row group
+    void read_exactly(parquet::ColumnReader *reader, int64_t n, std::vector<int32_t> &out,
+                    const std::string &column, const std::string &path){
+        if (read_batch(reader, n, out) != n) {
+            throw std::runtime_error("Column " + column + " ended early in " + path);
+        }
+    }
+}
+
+std::vector<InputFile> find_discharge_inputs(std::string input){
+    namespace fs = std::filesystem;
+    std::vector<InputFile> files;
+    std::vector<fs::path> paths;
+    if (fs::is_regular_file(input)) {
+        paths.push_back(input);
+    } else {
+        fs::path root = fs::path(input).lexically_normal();
+        if (root.filename().empty()) {root = root.parent_path();}    // trailing separator
+        for (auto & entry : fs::recursive_directory_iterator(root)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".parquet") {continue;}
+            if (!is_discharge_file(root, entry.path())) {continue;}
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    for (auto & path : paths) {
+        InputFile file;
+        file.path = path.string();
+        file.run = run_from_name(path.filename().string());
+        std::unique_ptr<parquet::ParquetFileReader> reader = parquet::ParquetFileReader::OpenFile(file.path, true);
+        // unweighted statistics of a --discharge_sample output would be biased
+        if (reader->metadata()->schema()->ColumnIndex("sample_weight") >= 0) {
+            throw std::runtime_error(file.path + " is a weighted discharge sample, which simstats cannot summarise");
+        }
+        file.n_row_groups = reader->metadata()->num_row_groups();
+        files.push_back(file);
+    }
+    return files;
+}
+
+DischargeScanner::DischargeScanner(std::vector<InputFile> files, int warmup) : files(files), warmup(warmup) {}
+
+void DischargeScanner::scan(ScanTask task, std::map<RunKey, RunStatistics> &stats){
+    const InputFile &file = files[task.file];
+    if (task.file != open_file) {
+        reader = parquet::ParquetFileReader::OpenFile(file.path, true);   // memory-mapped
+        open_file = task.file;
+    }
+    const parquet::SchemaDescriptor *schema = reader->metadata()->schema();
+    std::shared_ptr<parquet::RowGroupReader> rg = reader->RowGroup(task.row_group);
+
+    std::vector<std::shared_ptr<parquet::ColumnReader>> cols;
+    for (auto & name : int_columns) {
+        int idx = schema->ColumnIndex(name);
+        if (idx < 0) {throw std::runtime_error("Column " + name + " missing in " + file.path);}
+        cols.push_back(rg->Column(idx));
+    }
+    int age_out_idx = schema->ColumnIndex("age_out");
+    int run_idx = schema->ColumnIndex("run_id");
+    int scenario_idx = schema->ColumnIndex("scenario_id");
+    if (age_out_idx < 0) {throw std::runtime_error("Column age_out missing in " + file.path);}
+    if (run_idx < 0 && file.run < 0) {
+        throw std::runtime_error("No run_id column or run index in the name of " + file.path);
+    }
+    std::shared_ptr<parquet::ColumnReader> age_out_col = rg->Column(age_out_idx);
+    std::shared_ptr<parquet::ColumnReader> run_col = run_idx < 0 ? nullptr : rg->Column(run_idx);
+    std::shared_ptr<parquet::ColumnReader> scenario_col = scenario_idx < 0 ? nullptr : rg->Column(scenario_idx);
+
+    const int64_t batch = 1 << 16;
+    std::vector<std::vector<int32_t>> v(N_INT_COLUMNS);
+    std::vector<int32_t> age_out, run_ids, scenario_ids;
+    RunStatistics *current = nullptr;
+    RunKey current_key = {-1, -1};
+    while (cols[0]->HasNext()) {
+        int64_t n = read_batch(cols[0].get(), batch, v[0]);
+        for (int c = 1; c < N_INT_COLUMNS; c++) {read_exactly(cols[c].get(), n, v[c], int_columns[c], file.path);}
+        read_exactly(age_out_col.get(), n, age_out, "age_out", file.path);
+        if (run_col) {read_exactly(run_col.get(), n, run_ids, "run_id", file.path);}
+        if (scenario_col) {read_exactly(scenario_col.get(), n, scenario_ids, "scenario_id", file.path);}
+        for (int64_t i = 0; i < n; i++) {
+            RunKey key = {scenario_col ? scenario_ids[i] : 0, run_col ? run_ids[i] : file.run};
+            if (key != current_key) {
+                auto it = stats.find(key);
+                if (it == stats.end()) {it = stats.emplace(key, RunStatistics(warmup)).first;}
+                current = &it->second;
+                current_key = key;
+            }
+            int arrival_t = v[ARRIVAL_T][i];
+            bool waitlist_age_out = age_out[i] && v[FIRST_APPT][i] == -1;
+            // as RunStatistics::add_aged_out: a waitlist age-out's wait is its time to age out
+            int wait = waitlist_age_out ? v[DISCHARGE_T][i] - arrival_t : v[WAIT][i];
+            current->add_discharge(v[CLASS][i], arrival_t, wait,
+                                v[DISCHARGE_T][i] - arrival_t, v[N_APPTS][i],
+                                v[MODALITY_SUM][i], age_out[i], waitlist_age_out);
+        }
+    }
+}
@@ -0,0 +1,218 @@
+#include "Federation.h"
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include "DischargeList.h"
+#include "Waitlist.h"
+#include "Simulation.h"
+#include "Replication.h"
+#include "WriteCSV.h"
+
+// reusable barrier (C++17 has no std::barrier); abort releases every waiter
+class Federation::Barrier{
+    public:
+        Barrier(int n) : n(n) {}
+
+        // false once the barrier has been aborted
+        bool arrive_and_wait(){
+            std::unique_lock<std::mutex> lock(m);
+            if (aborted) {return false;}
+            long gen = generation;
+            if (++waiting == n) {
+                waiting = 0;
+                generation += 1;
+                cv.notify_all();
+                return true;
+            }
+            cv.wait(lock, [&]{return gen != generation || aborted;});
+            return !aborted;
+        }
+
+        void abort(){
+            std::lock_guard<std::mutex> lock(m);
+            aborted = true;
+            cv.notify_all();
+        }
+
+    private:
+        std::mutex m;
+        std::condition_variable cv;
+        int n;
+        int waiting = 0;
+        long generation = 0;
+        bool aborted = false;
+};
+
+// one site's state; streams are derived from (seed, run, stream, site)
+struct Federation::Site{
+    int id;
+    std::mt19937 wl_gen;
+    std::mt19937 sim_gen;
+    std::mt19937 route_gen;     // referral decisions
+    DischargeList dl;
+    Waitlist wl;
+    Simulation sim;
+    int epoch = 0;
+    std::exception_ptr error;
+
+    Site(SimConfig &cfg, int id, int run, std::string run_path)
+        : id(id), wl_gen(seed(cfg, run, 0u, id)), sim_gen(seed(cfg, run, 1u, id)),
+        route_gen(seed(cfg, run, 3u, id)),
+        dl(run_path.empty() ? DischargeList() : DischargeList(run_path)),
+        wl(cfg.pathways.size(), cfg.max_ax_age, cfg.priority_wlist, cfg.p_order, wl_gen, dl),
+        sim(make_simulation(cfg, dl, wl)) {
+        dl.set_warmup(cfg.warmup);
+        wl.set_selection_policy(cfg.wl_policy, cfg.fair_weights);
+        sim.set_rng(sim_gen);
+    }
+
+    static std::mt19937 seed(const SimConfig &cfg, int run, unsigned int stream, int site){
+        std::seed_seq seq{cfg.seed, (unsigned int) run, stream, (unsigned int) site};
+        return std::mt19937(seq);
+    }
+};
+
+Federation::Federation(SimConfig cfg, int n_sites, std::vector<int> site_servers,
+                    std::vector<double> site_arr_lam, double transfer_prob)
+                    : cfg(cfg), n_sites(n_sites), transfer_prob(transfer_prob) {
+    if (n_sites < 1) {
+        throw std::runtime_error("Federation needs at least one site");
+    }
+    if (!site_servers.empty() && site_servers.size() != n_sites) {
+        throw std::runtime_error("Federation needs one server count per site");
+    }
+    if (!site_arr_lam.empty() && site_arr_lam.size() != n_sites) {
+        throw std::runtime_error("Federation needs one arrival rate per site");
+    }
+    if (transfer_prob < 0 || transfer_prob > 1 || (n_sites == 1 && transfer_prob > 0)) {
+        throw std::runtime_error("Transfer probability must be in [0, 1] and needs a second site");
+    }
+    if (!cfg.arrival_trace.empty()) {
+        throw std::runtime_error("Federation needs sampled arrivals, traces are per site");
+    }
+    if (cfg.compact_output || cfg.output_layout != "flat" || cfg.discharge_sample > 0
+        || cfg.waitlist_logging || cfg.appointment_log || cfg.utilisation_log) {
+        throw std::runtime_error("Federation writes full flat discharge files only, without --compact_output, "
+                                "--output_layout hive, --discharge_sample or waitlist/appointment/utilisation logs");
+    }
+    if (cfg.stability_check || cfg.batch_means) {
+        throw std::runtime_error("Federation runs every site to --n_epochs, without --stability_check or --batch_means");
+    }
+    for (int s = 0; s < n_sites; s++) {
+        SimConfig site_cfg = cfg;
+        if (!site_servers.empty()) {site_cfg.n_servers = site_servers[s];}
+        if (!site_arr_lam.empty()) {site_cfg.arr_lam = site_arr_lam[s];}
+        site_cfgs.push_back(site_cfg);
+    }
+    for (int p = 0; p < 2; p++) {outbox[p].resize(n_sites * n_sites);}
+}
+
+std::vector<RunStatistics> Federation::run(int run, bool write_output){
+    std::vector<std::unique_ptr<Site>> sites;
+    for (int s = 0; s < n_sites; s++) {
+        std::string run_path = "";
+        if (write_output) {
+            std::string site_dir = cfg.folder + "site=" + std::to_string(s) + "/";
+            std::filesystem::create_directories(site_dir);
+            run_path = site_dir + "simulation_data_" + std::to_string(run) + ".parquet";
+        }
+        sites.push_back(std::make_unique<Site>(site_cfgs[s], s, run, run_path));
+    }
+    for (int p = 0; p < 2; p++) {
+        for (auto & box : outbox[p]) {box.clear();}
+    }
+    // referral routing runs on the sending site's thread and only touches its own outbox row
+    for (auto & site : sites) {
+        Site *src = site.get();
+        std::uniform_real_distribution<double> transfer(0, 1);
+        std::uniform_int_distribution<int> other(0, n_sites - 2);
+        src->sim.set_arrival_router([this, src, transfer, other](const WaitlistEntry &entry) mutable {
+            if (transfer_prob == 0 || transfer(src->route_gen) >= transfer_prob) {return false;}
+            int dst = other(src->route_gen);
+            if (dst >= src->id) {dst += 1;}
+            outbox[src->epoch % 2][src->id * n_sites + dst].push_back(entry);
+            return true;
+        });
+        site->sim.generate_servers();
+        site->sim.prefill_waitlist(site_cfgs[site->id].waitlist_prefill);
+    }
+
+    Barrier barrier(n_sites);
+    std::vector<std::thread> threads;
+    for (auto & site : sites) {
+        Site *s = site.get();
+        threads.push_back(std::thread([this, s, &barrier]{
+            try {
+                Federation::run_site(*s, barrier);
+            } catch (...) {
+                s->error = std::current_exception();
+                barrier.abort();
+            }
+        }));
+    }
+    for (auto & thread : threads) {thread.join();}
+    for (auto & site : sites) {
+        if (site->error) {std::rethrow_exception(site->error);}
+    }
+
+    std::vector<RunStatistics> stats;
+    reports.clear();
+    for (auto & site : sites) {
+        SiteReport report;
+        report.arrivals = site->sim.get_n_admitted();
+        report.referred_out = site->sim.get_n_referred_out();
+        report.referred_in = site->sim.get_n_referred_in();
+        report.discharged = site->sim.get_n_discharged();
+        report.waitlist = site->sim.get_n_waitlist();
+        reports.push_back(report);
+
+        RunStatistics site_stats = site->dl.get_statistics();
+        site_stats.n_arrivals = report.arrivals - report.referred_out + report.referred_in;
+        site_stats.n_discharged = report.discharged;
+        site_stats.n_waitlist = report.waitlist;
+        site_stats.epochs_run = site->sim.get_epochs_run();
+        stats.push_back(site_stats);
+    }
+    return stats;
+}
+
+// referrals posted in epoch e join the destination waitlist at the start of e + 1
+void Federation::run_site(Site &site, Barrier &barrier){
+    for (int epoch = 0; epoch < cfg.n_epochs; epoch++) {
+        int parity = epoch % 2;
+        // everyone read this parity's buffers before the previous barrier
+        for (int dst = 0; dst < n_sites; dst++) {outbox[parity][site.id * n_sites + dst].clear();}
+        for (int src = 0; src < n_sites; src++) {
+            site.sim.receive_referrals(epoch, outbox[1 - parity][src * n_sites + site.id]);
+        }
+        site.epoch = epoch;
+        site.sim.step(epoch);
+        if (!barrier.arrive_and_wait()) {return;}
+    }
+}
+
+void Federation::write_results(std::string path){
+    if (reports.empty()) {
+        throw std::runtime_error("Federation has not been run");
+    }
+    std::vector<std::pair<std::string, double>> dataset;
+    long in_transit = 0;
+    for (int s = 0; s < n_sites; s++) {
+        std::string prefix = "site_" + std::to_string(s) + "_";
+        dataset.push_back({prefix + "servers", double(site_cfgs[s].n_servers)});
+        dataset.push_back({prefix + "arrivals", double(reports[s].arrivals)});
+        dataset.push_back({prefix + "referred_out", double(reports[s].referred_out)});
+        dataset.push_back({prefix + "referred_in", double(reports[s].referred_in)});
+        dataset.push_back({prefix + "discharged", double(reports[s].discharged)});
+        dataset.push_back({prefix + "waitlist", double(reports[s].waitlist)});
+        in_transit += reports[s].referred_out - reports[s].referred_in;
+    }
+    dataset.push_back({"in_transit", double(in_transit)});   // posted in the final epoch
+    write_csv(path, dataset);
+}
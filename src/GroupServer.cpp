@@ -15,41 +15,59 @@ GroupServer::GroupServer(int path, int path_len, int max_caseload,
     GroupServer::set_n_appts(path_len);
 };
 
+GroupServer::GroupServer(const GroupServer &other, Waitlist &wl, DischargeList &dl)
+    : Server::Server(other, wl, dl), path(other.path), path_len(other.path_len), n_appts(other.n_appts) {}
+
 // setter methods
 void GroupServer::set_path(int p){path = p;}
 void GroupServer::set_path_len(int pl){path_len = pl;}
 void GroupServer::set_n_appts(int n){n_appts = n;}
 void GroupServer::reset_n_appts(){n_appts = path_len;}
 
+// getter methods
+bool GroupServer::is_idle(){return order.size() == 0;}
+int GroupServer::get_path(){return path;}
+
 // incrementer/decrementer methods
 void GroupServer::decrement_n_appts(){n_appts -= 1;}
 
 void GroupServer::discharge_patients(int epoch){
-    while (caseload.size() > 0) {
-            Patient p = caseload.front();
-            caseload.pop_front();
-            p.set_discharge_time(epoch);
-            discharge_list.add_patient(p);
-            n_patients -= 1;
+    while (order.size() > 0) {
+        Patient &p = Server::patient_at(0);
+        p.set_discharge_time(epoch);
+        discharge_list.add_patient(p);
+        Server::remove_current();
     }
 }
 
+// add a new cohort of patients from the server's own pathway
+bool GroupServer::form_group(int epoch){
+    std::vector<std::pair<Patient, int>> cohort = waitlist.get_class_patients(path, max_caseload, epoch);
+    if (cohort.size() == 0) {return false;}
+    for (auto & pair : cohort) {
+        pair.first.add_wait(epoch);
+        Server::add_patient(pair.first);
+    }
+    GroupServer::reset_n_appts();
+    return true;
+}
+
 // redefine process epoch
+// idle servers are filled beforehand by form_group (see Simulation::form_groups)
 void GroupServer::process_epoch(int epoch) {
-    // add new batch of patients
-    if (n_patients == 0){
-        while (caseload.size() < max_caseload & waitlist.check_class_availability(path, epoch)) {
-            Server::add_from_waitlist(epoch);
-        }
-        GroupServer::reset_n_appts();
+    if (order.size() == 0) {return;}
+    // every member is seen each session (capacity used even if a patient
+    // advance cancels), so a full cycle leaves the cursor where it started
+    for (int i = 0; i < order.size(); i++) {
+        Patient &p = Server::patient_at(i);
+        p.process_patient(epoch);
+        discharge_list.add_appointment(p, epoch);
+        if (utilisation) {utilisation->mark(UtilisationLog::GROUP, first_slot + i, path, p.get_last_outcome());}
     }
-    int capacity = n_patients;
-    while (capacity > 0) {
-        Patient p = caseload.front();
-        caseload.pop_front();
-        std::array<int, 2> results = p.process_patient(epoch);
-        capacity -= 1;  // capacity used even if patient advance canceled
-        caseload.push_back(p);
+    if (utilisation) {
+        for (int i = order.size(); i < max_caseload; i++) {
+            utilisation->mark(UtilisationLog::GROUP, first_slot + i, path, UtilisationLog::UNFILLED);
+        }
     }
     GroupServer::decrement_n_appts();
     if (n_appts == 0) { // if group finished -> discharge all
@@ -0,0 +1,89 @@
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "arrow/memory_pool.h"
+
+namespace {
+    memory_tracker::Counters subsystem_counters[memory_tracker::N_SUBSYSTEMS];
+    std::atomic<long> n_heap_allocs{0};
+    const char* subsystem_names[memory_tracker::N_SUBSYSTEMS] = {"waitlist", "caseload", "appointments"};
+}
+
+#ifdef SIM_MEMORY_TRACKING
+// count every heap allocation so per-epoch figures include untracked containers
+void* operator new(std::size_t size){
+    n_heap_allocs.fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if (p == nullptr) {throw std::bad_alloc();}
+    return p;
+}
+void operator delete(void *p) noexcept {std::free(p);}
+void operator delete(void *p, std::size_t) noexcept {std::free(p);}
+#endif
+
+memory_tracker::Counters& memory_tracker::counters(Subsystem s){return subsystem_counters[s];}
+
+const char* memory_tracker::name(Subsystem s){return subsystem_names[s];}
+
+bool memory_tracker::enabled(){
+#ifdef SIM_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void memory_tracker::on_alloc(Subsystem s, std::size_t bytes){
+    Counters &c = subsystem_counters[s];
+    c.n_allocs.fetch_add(1, std::memory_order_relaxed);
+    long live = c.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    long peak = c.peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void memory_tracker::on_free(Subsystem s, std::size_t bytes){
+    subsystem_counters[s].live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+long memory_tracker::heap_allocations(){return n_heap_allocs.load(std::memory_order_relaxed);}
+
+void memory_tracker::start_run(){
+    for (auto & c : subsystem_counters) {
+        c.n_allocs.store(0);
+        c.peak_bytes.store(c.live_bytes.load());
+    }
+}
+
+void memory_tracker::EpochSampler::start(){
+    last = memory_tracker::heap_allocations();
+}
+
+void memory_tracker::EpochSampler::sample(){
+    long now = memory_tracker::heap_allocations();
+    long delta = now - last;
+    last = now;
+    total += delta;
+    if (delta > max) {max = delta;}
+    n_epochs += 1;
+}
+
+std::vector<std::pair<std::string, double>> memory_tracker::report(const EpochSampler &sampler){
+    std::vector<std::pair<std::string, double>> rows;
+    for (int s = 0; s < N_SUBSYSTEMS; s++) {
+        const Counters &c = subsystem_counters[s];
+        std::string prefix = std::string("mem_") + subsystem_names[s];
+        rows.push_back({prefix + "_allocs", double(c.n_allocs.load())});
+        rows.push_back({prefix + "_live_bytes", double(c.live_bytes.load())});
+        rows.push_back({prefix + "_peak_bytes", double(c.peak_bytes.load())});
+    }
+    // parquet/arrow buffers come from arrow's own pool
+    arrow::MemoryPool *pool = arrow::default_memory_pool();
+    rows.push_back({"mem_parquet_live_bytes", double(pool->bytes_allocated())});
+    rows.push_back({"mem_parquet_peak_bytes", double(pool->max_memory())});
+    rows.push_back({"heap_allocs_run", double(sampler.total)});
+    rows.push_back({"heap_allocs_per_epoch_mean", sampler.n_epochs > 0 ? double(sampler.total) / sampler.n_epochs : 0});
+    rows.push_back({"heap_allocs_per_epoch_max", double(sampler.max)});
+    return rows;
+}
@@ -1,5 +1,6 @@
 #include "Patient.h"
 #include <iostream>
+#include <stdexcept>
 
 // To-Do List:
 // 1. Implement passing max age
@@ -22,7 +23,8 @@ Patient::Patient(int arrival_time, double arrival_age, int pathway, int base_dur
 }
 
 void Patient::add_appt(int epoch){
-    appt_epochs.push_back(epoch);
+    if (n_appts == 0) {first_appt = epoch;}
+    n_appts += 1;
 }
 
 void Patient::add_wait(int add_t){
@@ -30,14 +32,17 @@ void Patient::add_wait(int add_t){
     Patient::add_wait_effect();
 }
 
+// att_probs are cumulative
 int Patient::check_attendance(int modality) {
     float prob = modality_dstb(rng);
     if (prob <= att_probs[modality][0]) {
-        return 0;
+        return ATTENDED;
+    } else if (prob <= att_probs[modality][1]) {
+        return NO_SHOW;
     } else if (prob <= att_probs[modality][2]) {
-        return 1;
+        return LATE_CANCEL;
     } else {
-        return 2;
+        return ADVANCE_CANCEL;
     }
 }
 
@@ -51,21 +56,25 @@ std::array<int, 2> Patient::process_patient(int epoch){
     }
     int att = Patient::check_attendance(modality);
     int check = 0;
+    last_modality = modality;
+    last_outcome = att;
 
     switch (att) {
-        case 0:
+        case ATTENDED:
             Patient::add_appt(epoch);
             Patient::increment_modality_sum(modality); // increment modality sum
             Patient::add_modality_effect();
             check = Patient::check_complete(epoch);
             return std::array<int, 2> {1, check};
-        case 1:
+        case NO_SHOW:
+        case LATE_CANCEL:   // slot is lost either way
             check = Patient::check_complete(epoch);
             return std::array<int, 2> {1, check};
-        case 2:
+        case ADVANCE_CANCEL:
             check = Patient::check_complete(epoch);
             return std::array<int, 2> {0, check};
     }
+    throw std::logic_error("Unknown attendance outcome");
 }
 
 // calculate the effect of waiting on service duration
@@ -88,7 +97,7 @@ void Patient::add_wait_effect(){
 
 // calculate the proportion of in-person visits
 float Patient::calculate_modality_effect(){
-    return modality_effect*float(modality_sum)/float(appt_epochs.size());
+    return modality_effect*float(modality_sum)/float(n_appts);
 }
 
 void Patient::add_modality_effect(){
@@ -105,7 +114,7 @@ void Patient::add_modality_effect(){
 // check if the patient has completed their service
 // To-Do: Implement passing max age
 int Patient::check_complete(int epoch){
-    if (appt_epochs.size() >= service_duration){
+    if (n_appts >= service_duration){
         set_discharge_duration(service_duration);
         return 1;
     } else if (get_age(epoch) > 4.0) {
@@ -134,6 +143,7 @@ void Patient::set_discharge_duration(int d){discharge_duration=d;}
 void Patient::set_age_out(int a){age_out=a;}
 void Patient::set_modality_policy(double p){modality_policy=p;}
 void Patient::set_modality_dstb(std::uniform_real_distribution<> dstb){modality_dstb=dstb;}
+void Patient::set_id(int i){id=i;}
 
 // extraneous get-set methods
 int Patient::get_pathway(){return pathway;}
@@ -148,14 +158,9 @@ float Patient::get_age(int epoch){
 
 float Patient::get_arrival_age(){return float(arrival_age);}
 
-int Patient::get_first_appt(){
-    if (appt_epochs.size() == 0){
-        return -1;
-    }
-    return appt_epochs[0];
-}
+int Patient::get_first_appt(){return first_appt;}
 
-int Patient::get_n_appts(){return appt_epochs.size();}
+int Patient::get_n_appts(){return n_appts;}
 
 int Patient::get_n_ext(){return extended;}
 
@@ -172,13 +177,19 @@ int Patient::get_discharge_duration(){return discharge_duration;}
 int Patient::get_age_out(){return age_out;}
 
 float Patient::get_pct_face(){
-    if (appt_epochs.size() == 0) {
+    if (n_appts == 0) {
         return 0.0;
     }
-    return float(modality_sum)/float(appt_epochs.size());
+    return float(modality_sum)/float(n_appts);
 }
 
 int Patient::get_modality_sum(){return modality_sum;}
 
+int Patient::get_id(){return id;}
+
+int Patient::get_last_modality(){return last_modality;}
+
+int Patient::get_last_outcome(){return last_outcome;}
+
 // Incrementer methods
 void Patient::increment_modality_sum(int m){modality_sum += m;}
\ No newline at end of file
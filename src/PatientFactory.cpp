@@ -0,0 +1,29 @@
+#include "PatientFactory.h"
+
+#include <random>
+#include <string>
+#include <stdexcept>
+#include "Patient.h"
+#include "WaitlistEntry.h"
+
+PatientFactory::PatientFactory(){}
+
+PatientFactory::PatientFactory(std::vector<double> wait_effects, std::vector<double> modality_effects,
+                            std::vector<double> modality_policies,
+                            const std::array<std::array<double, 4>, 2> &att_probs) :
+                            wait_effects(wait_effects), modality_effects(modality_effects),
+                            modality_policies(modality_policies), att_probs(att_probs) {}
+
+Patient PatientFactory::make_patient(const WaitlistEntry &entry, std::mt19937 &gen, int id){
+    std::mt19937 patient_gen(gen());
+    int c = entry.pathway;
+    // a default-constructed factory has no classes, so this also catches a missing set_patient_factory
+    if (c < 0 || c >= wait_effects.size()) {
+        throw std::runtime_error("PatientFactory has no parameters for pathway " + std::to_string(c));
+    }
+    Patient patient(entry.arrival_time, entry.arrival_age, c, entry.base_duration,
+                    wait_effects[c], modality_effects[c], modality_policies[c],
+                    att_probs, patient_gen);
+    patient.set_id(id);
+    return patient;
+}
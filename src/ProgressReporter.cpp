@@ -0,0 +1,108 @@
+#include "ProgressReporter.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+ProgressReporter::ProgressReporter(){}
+
+ProgressReporter::ProgressReporter(double interval, std::string status_path, int run, int n_epochs) :
+                                interval(interval), status_path(status_path), run(run),
+                                n_epochs(n_epochs) {
+    enabled = interval > 0;
+}
+
+bool ProgressReporter::is_enabled(){return enabled;}
+
+void ProgressReporter::start(){
+    if (!enabled) {return;}
+    start_t = clock::now();
+    last_t = start_t;
+    next_t = start_t + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(interval));
+    last_epochs = 0;
+    last_discharged = 0;
+}
+
+void ProgressReporter::update(int epochs_done, long n_arrivals, long n_discharged, int n_waitlist){
+    if (!enabled) {return;}
+    clock::time_point now = clock::now();
+    if (now < next_t) {return;}
+    next_t = now + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(interval));
+    ProgressReporter::report(epochs_done, n_arrivals, n_discharged, n_waitlist, false);
+}
+
+void ProgressReporter::finish(int epochs_done, long n_arrivals, long n_discharged, int n_waitlist){
+    if (!enabled) {return;}
+    ProgressReporter::report(epochs_done, n_arrivals, n_discharged, n_waitlist, true);
+}
+
+void ProgressReporter::report(int epochs_done, long n_arrivals, long n_discharged, int n_waitlist, bool final){
+    clock::time_point now = clock::now();
+    double elapsed = std::chrono::duration<double>(now - start_t).count();
+    double dt = std::chrono::duration<double>(now - last_t).count();
+    // rates over the last interval, ETA from the run average
+    double epoch_rate = dt > 0 ? (epochs_done - last_epochs) / dt : 0;
+    double patient_rate = dt > 0 ? (n_discharged - last_discharged) / dt : 0;
+    double avg_rate = elapsed > 0 ? epochs_done / elapsed : 0;
+    double eta = avg_rate > 0 ? (n_epochs - epochs_done) / avg_rate : -1;
+    if (final) {eta = 0;}
+    long rss = ProgressReporter::rss_bytes();
+    last_t = now;
+    last_epochs = epochs_done;
+    last_discharged = n_discharged;
+
+    std::cerr << "[run " << run << "] epoch " << epochs_done << "/" << n_epochs
+                << std::fixed << std::setprecision(1)
+                << " | " << epoch_rate << " epochs/s | " << patient_rate << " patients/s"
+                << " | ETA " << eta << "s | waitlist " << n_waitlist
+                << " | RSS " << (rss < 0 ? -1.0 : rss / 1048576.0) << " MB"
+                << (final ? " | done" : "") << std::defaultfloat << std::endl;
+
+    if (status_path.empty()) {return;}
+    std::ostringstream json;
+    json << "{\"run\": " << run
+        << ", \"epoch\": " << epochs_done
+        << ", \"n_epochs\": " << n_epochs
+        << ", \"elapsed_s\": " << elapsed
+        << ", \"epochs_per_s\": " << epoch_rate
+        << ", \"patients_per_s\": " << patient_rate
+        << ", \"eta_s\": " << eta
+        << ", \"n_arrivals\": " << n_arrivals
+        << ", \"n_discharged\": " << n_discharged
+        << ", \"waitlist\": " << n_waitlist
+        << ", \"rss_bytes\": " << rss
+        << ", \"done\": " << (final ? "true" : "false") << "}\n";
+    ProgressReporter::write_status(json.str());
+}
+
+// write beside the target and rename over it (atomic on POSIX filesystems)
+void ProgressReporter::write_status(const std::string &json){
+    std::string tmp = status_path + ".tmp";
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Could not write status file " << tmp << std::endl;
+        return;
+    }
+    out << json;
+    out.close();
+    if (std::rename(tmp.c_str(), status_path.c_str()) != 0) {
+        std::cerr << "Could not replace status file " << status_path << std::endl;
+    }
+}
+
+long ProgressReporter::rss_bytes(){
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    long size = 0;
+    long resident = 0;
+    if (statm >> size >> resident) {
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,118 @@
+#include "Replication.h"
+
+#include <cmath>
+#include <random>
+#include <memory>
+#include <stdexcept>
+#include "SimConfig.h"
+#include "RunStatistics.h"
+#include "Simulation.h"
+#include "Waitlist.h"
+#include "DischargeList.h"
+#include "MemoryTracker.h"
+#include "ArrivalTrace.h"
+
+int utilization_to_servers(float utilization, std::vector<int> pathways,
+                            std::vector<double> probs, double arr_lam){
+    float mu = 0;
+    for (int i = 0; i < pathways.size(); i++){
+        mu += probs[i] * arr_lam * pathways[i];
+    }
+    return ceil(mu/utilization);
+}
+
+Simulation make_simulation(const SimConfig &cfg, DischargeList &dl, Waitlist &wl,
+                        std::string waitlist_path){
+    double att_probs[2][4] = {0};
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 4; j++) {
+            att_probs[i][j] = cfg.att_probs[i][j];
+        }
+    }
+    if (cfg.arrival_sampler != "alias" && cfg.arrival_sampler != "reference") {
+        throw std::runtime_error("Unknown arrival sampler: " + cfg.arrival_sampler);
+    }
+    Simulation sim = Simulation(cfg.n_epochs, cfg.n_servers,
+                                cfg.n_group_servers,
+                                cfg.group_size_props,
+                                cfg.group_size_effects,
+                                cfg.max_caseload, cfg.arr_lam,
+                                cfg.pathways, cfg.wait_effects,
+                                cfg.modality_effects, cfg.modality_policies,
+                                att_probs,
+                                cfg.probs, cfg.age_params,
+                                cfg.max_ax_age, waitlist_path,
+                                cfg.waitlist_logging & !waitlist_path.empty(),
+                                dl, wl);
+    sim.set_alias_sampling(cfg.arrival_sampler == "alias");
+    return sim;
+}
+
+RunStatistics run_replication(const SimConfig &cfg, int run,
+                            std::string run_path, std::string waitlist_path,
+                            DatasetWriter *dataset, std::string appointment_path,
+                            std::string utilisation_path){
+    // separate streams for the waitlist and the arrival process
+    std::seed_seq wl_seq{cfg.seed, (unsigned int) run, 0u};
+    std::seed_seq sim_seq{cfg.seed, (unsigned int) run, 1u};
+    std::mt19937 wl_gen(wl_seq);
+    std::mt19937 sim_gen(sim_seq);
+
+    std::vector<int> p_order = cfg.p_order;
+
+    BatchMeans batch_means = BatchMeans(cfg.pathways.size(), cfg.warmup, cfg.batch_count,
+                                        cfg.batch_min, cfg.batch_alpha);
+
+    // initialize waitlist and discharge list instances
+    OutputOptions output;
+    output.compact = cfg.compact_output;
+    output.run_id = run;
+    output.scenario_id = cfg.scenario_id;
+    output.dataset = dataset;
+    output.sample_size = cfg.discharge_sample;
+    if (cfg.discharge_sample > 0) {
+        std::seed_seq sample_seq{cfg.seed, (unsigned int) run, 4u};
+        std::mt19937 sample_gen(sample_seq);
+        output.sample_seed = sample_gen();
+    }
+    DischargeList dl = dataset != nullptr ? DischargeList(output)
+                        : run_path.empty() ? DischargeList() : DischargeList(run_path, output);
+    dl.set_warmup(cfg.warmup);
+    if (!appointment_path.empty()) {dl.set_appointment_log(appointment_path);}
+    if (cfg.batch_means) {dl.set_batch_means(&batch_means);}
+    Waitlist wl = Waitlist(cfg.pathways.size(), cfg.max_ax_age,
+                            cfg.priority_wlist, p_order,
+                            wl_gen, dl);
+    wl.set_selection_policy(cfg.wl_policy, cfg.fair_weights);
+    Simulation sim = make_simulation(cfg, dl, wl, waitlist_path);
+    sim.set_rng(sim_gen);
+    if (!cfg.arrival_trace.empty()) {
+        sim.set_arrival_trace(std::make_shared<ArrivalTrace>(cfg.arrival_trace, cfg.pathways));
+    }
+    if (cfg.stability_check) {
+        sim.set_stability_monitor(StabilityMonitor(cfg.stability_window, cfg.stability_min_windows,
+                                                cfg.stability_alpha, cfg.stability_tolerance));
+    }
+    if (cfg.progress_interval > 0) {
+        sim.set_progress_reporter(ProgressReporter(cfg.progress_interval, cfg.status_file, run, cfg.n_epochs));
+    }
+    if (cfg.batch_means) {sim.set_batch_means(&batch_means);}
+    memory_tracker::start_run();
+    sim.generate_servers();
+    if (!utilisation_path.empty()) {sim.set_utilisation_log(utilisation_path);}
+    sim.prefill_waitlist(cfg.waitlist_prefill); // prefill the waitlist
+    sim.run();
+    dl.write_sample();
+
+    RunStatistics stats = dl.get_statistics();
+    stats.n_arrivals = sim.get_n_admitted();
+    stats.n_discharged = sim.get_n_discharged();
+    stats.n_waitlist = sim.get_n_waitlist();
+    stats.epochs_run = sim.get_epochs_run();
+    stats.stable = !sim.is_unstable();
+    if (cfg.batch_means) {stats.batch_means = batch_means.estimates(cfg.batch_confidence);}
+    if (memory_tracker::enabled()) {
+        stats.memory = memory_tracker::report(sim.get_alloc_sampler());
+    }
+    return stats;
+}
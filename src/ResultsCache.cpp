@@ -0,0 +1,220 @@
+#include "ResultsCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+    template <typename T>
+    std::string join(const T &xs){
+        std::ostringstream s;
+        s << std::setprecision(17);
+        for (int i = 0; i < xs.size(); i++) {s << (i ? "," : "") << xs[i];}
+        return s.str();
+    }
+
+    std::string hex(uint64_t h){
+        std::ostringstream s;
+        s << std::hex << std::setw(16) << std::setfill('0') << h;
+        return s.str();
+    }
+
+    std::string read_file(const fs::path &path){
+        std::ifstream in(path);
+        std::stringstream s;
+        s << in.rdbuf();
+        return s.str();
+    }
+
+    uintmax_t dir_size(const fs::path &dir){
+        uintmax_t bytes = 0;
+        for (auto & f : fs::recursive_directory_iterator(dir)) {
+            if (f.is_regular_file()) {bytes += f.file_size();}
+        }
+        return bytes;
+    }
+}
+
+ResultsCache::ResultsCache(std::string d) : dir(d) {
+    if (!dir.empty() && dir.back() != '/') {dir += "/";}
+    fs::create_directories(dir);
+}
+
+std::string ResultsCache::config_key(const SimConfig &cfg, int run){
+    std::ostringstream k;
+    k << std::setprecision(17);
+    k << "engine=" << ENGINE_VERSION << "\n"
+        << "seed=" << cfg.seed << "\n"
+        << "run=" << run << "\n"
+        << "n_epochs=" << cfg.n_epochs << "\n"
+        << "waitlist_prefill=" << cfg.waitlist_prefill << "\n"
+        << "servers=" << cfg.n_servers << "\n"
+        << "n_group_servers=" << join(cfg.n_group_servers) << "\n"
+        << "group_size_props=" << join(cfg.group_size_props) << "\n"
+        << "group_size_effects=" << join(cfg.group_size_effects) << "\n"
+        << "max_caseload=" << cfg.max_caseload << "\n"
+        << "arr_lam=" << cfg.arr_lam << "\n"
+        << "arrival_probs=" << join(cfg.probs) << "\n"
+        << "pathways=" << join(cfg.pathways) << "\n"
+        << "wait_effects=" << join(cfg.wait_effects) << "\n"
+        << "modality_effects=" << join(cfg.modality_effects) << "\n"
+        << "modality_policies=" << join(cfg.modality_policies) << "\n"
+        << "max_ax_age=" << cfg.max_ax_age << "\n"
+        << "age_params=" << join(cfg.age_params) << "\n"
+        << "priority_order=" << join(cfg.p_order) << "\n"
+        << "priority_wlist=" << cfg.priority_wlist << "\n"
+        << "wl_policy=" << cfg.wl_policy << "\n"
+        << "fair_weights=" << join(cfg.fair_weights) << "\n"
+        << "virtual_att_probs=" << join(cfg.att_probs[0]) << "\n"
+        << "face_att_probs=" << join(cfg.att_probs[1]) << "\n"
+        << "warmup=" << cfg.warmup << "\n"
+        << "arrival_sampler=" << cfg.arrival_sampler << "\n"
+        << "arrival_trace=" << cfg.arrival_trace << "\n"
+        << "stability_check=" << cfg.stability_check << "\n";
+    if (!cfg.arrival_trace.empty()) {
+        // a rewritten trace must miss even under the same path
+        k << "arrival_trace_bytes=" << fs::file_size(cfg.arrival_trace) << "\n"
+            << "arrival_trace_mtime=" << fs::last_write_time(cfg.arrival_trace).time_since_epoch().count() << "\n";
+    }
+    if (cfg.stability_check) {
+        k << "stability_window=" << cfg.stability_window << "\n"
+            << "stability_min_windows=" << cfg.stability_min_windows << "\n"
+            << "stability_alpha=" << cfg.stability_alpha << "\n"
+            << "stability_tolerance=" << cfg.stability_tolerance << "\n";
+    }
+    return k.str();
+}
+
+std::string ResultsCache::output_variant(const SimConfig &cfg){
+    std::ostringstream v;
+    v << "compact_output=" << cfg.compact_output << "\n"
+        << "discharge_sample=" << cfg.discharge_sample << "\n"
+        << "scenario_id=" << cfg.scenario_id << "\n"
+        << "waitlist_log=" << cfg.waitlist_logging << "\n"
+        << "appointment_log=" << cfg.appointment_log << "\n"
+        << "utilisation_log=" << cfg.utilisation_log << "\n";
+    return v.str();
+}
+
+// 64-bit FNV-1a
+uint64_t ResultsCache::fnv1a(const std::string &text){
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::string ResultsCache::entry_dir(const std::string &key){return dir + hex(fnv1a(key)) + "/";}
+
+void ResultsCache::touch(const std::string &key){
+    fs::last_write_time(entry_dir(key) + "stats.txt", fs::file_time_type::clock::now());
+}
+
+bool ResultsCache::lookup(const std::string &key, RunStatistics &stats){
+    std::string entry = entry_dir(key);
+    if (!fs::exists(entry + "stats.txt") || read_file(entry + "key.txt") != key) {return false;}
+    stats = RunStatistics::load(entry + "stats.txt");
+    ResultsCache::touch(key);
+    return true;
+}
+
+// written to a temporary directory and renamed, so an interrupted store never leaves a partial hit
+void ResultsCache::store(const std::string &key, const RunStatistics &stats){
+    std::string entry = entry_dir(key);
+    std::string tmp = entry.substr(0, entry.size() - 1) + ".tmp/";
+    fs::remove_all(tmp);
+    fs::create_directories(tmp);
+    std::ofstream(tmp + "key.txt") << key;
+    stats.save(tmp + "stats.txt");
+    if (fs::exists(entry)) {
+        // keep cached outputs of other variants
+        for (auto & f : fs::directory_iterator(entry)) {
+            if (f.is_directory()) {fs::rename(f.path(), tmp + f.path().filename().string());}
+        }
+        fs::remove_all(entry);
+    }
+    fs::rename(tmp.substr(0, tmp.size() - 1), entry.substr(0, entry.size() - 1));
+}
+
+bool ResultsCache::restore_outputs(const std::string &key, const std::string &variant, std::string folder){
+    std::string outputs = entry_dir(key) + "outputs-" + hex(fnv1a(variant)) + "/";
+    if (!fs::is_directory(outputs)) {return false;}
+    fs::copy(outputs, folder, fs::copy_options::recursive | fs::copy_options::overwrite_existing);
+    return true;
+}
+
+void ResultsCache::store_outputs(const std::string &key, const std::string &variant,
+                                const std::vector<std::pair<std::string, std::string>> &files){
+    std::string outputs = entry_dir(key) + "outputs-" + hex(fnv1a(variant));
+    std::string tmp = outputs + ".tmp/";
+    fs::remove_all(tmp);
+    for (auto & f : files) {
+        if (!fs::exists(f.second)) {continue;}
+        fs::path target = tmp + f.first;
+        fs::create_directories(target.parent_path());
+        fs::copy_file(f.second, target, fs::copy_options::overwrite_existing);
+    }
+    fs::create_directories(tmp);
+    fs::remove_all(outputs);
+    fs::rename(tmp.substr(0, tmp.size() - 1), outputs);
+}
+
+void ResultsCache::list(std::ostream &out){
+    out << "hash,bytes,last_used,seed,run,outputs\n";
+    for (auto & e : fs::directory_iterator(dir)) {
+        fs::path stats = e.path() / "stats.txt";
+        if (!e.is_directory() || !fs::exists(stats)) {continue;}
+        std::string seed;
+        std::string run;
+        std::istringstream key(read_file(e.path() / "key.txt"));
+        for (std::string line; std::getline(key, line);) {
+            if (line.rfind("seed=", 0) == 0) {seed = line.substr(5);}
+            if (line.rfind("run=", 0) == 0) {run = line.substr(4);}
+        }
+        int n_outputs = 0;
+        for (auto & f : fs::directory_iterator(e.path())) {n_outputs += f.is_directory();}
+        auto age = fs::file_time_type::clock::now() - fs::last_write_time(stats);
+        out << e.path().filename().string() << "," << dir_size(e.path()) << ","
+            << std::chrono::duration_cast<std::chrono::seconds>(age).count() << "s ago,"
+            << seed << "," << run << "," << n_outputs << "\n";
+    }
+}
+
+void ResultsCache::evict(double max_mb){
+    std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+    uintmax_t total = 0;
+    for (auto & e : fs::directory_iterator(dir)) {
+        if (!e.is_directory()) {continue;}
+        fs::path stats = e.path() / "stats.txt";
+        if (!fs::exists(stats)) {
+            fs::remove_all(e.path());   // leftovers of an interrupted store
+            continue;
+        }
+        entries.push_back({fs::last_write_time(stats), e.path()});
+        total += dir_size(e.path());
+    }
+    std::sort(entries.begin(), entries.end());
+    uintmax_t limit = uintmax_t(max_mb * 1024 * 1024);
+    int n_evicted = 0;
+    for (auto & e : entries) {
+        if (total <= limit) {break;}
+        total -= dir_size(e.second);
+        fs::remove_all(e.second);
+        n_evicted += 1;
+    }
+    std::cout << "Evicted " << n_evicted << " of " << entries.size() << " cache entries, "
+            << total << " bytes remain" << std::endl;
+}
+
+void ResultsCache::clear(){
+    for (auto & e : fs::directory_iterator(dir)) {fs::remove_all(e.path());}
+}
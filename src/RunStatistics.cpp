@@ -0,0 +1,222 @@
+#include "RunStatistics.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include "Patient.h"
+
+// Histogram methods
+void Histogram::add(int value){
+    if (value < 0) {value = 0;}
+    if (value >= counts.size()) {
+        counts.resize(value + 1, 0);
+    }
+    counts[value] += 1;
+    n += 1;
+    sum += value;
+}
+
+void Histogram::merge(const Histogram &other){
+    if (other.counts.size() > counts.size()) {
+        counts.resize(other.counts.size(), 0);
+    }
+    for (int i = 0; i < other.counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    n += other.n;
+    sum += other.sum;
+}
+
+double Histogram::mean() const {
+    if (n == 0) {return std::numeric_limits<double>::quiet_NaN();}
+    return sum / n;
+}
+
+double Histogram::quantile(double q) const {
+    if (n == 0) {return std::numeric_limits<double>::quiet_NaN();}
+    // smallest value v with P(X <= v) >= q
+    long rank = std::max(1L, (long) ceil(q * n));
+    long cum = 0;
+    for (int i = 0; i < counts.size(); i++) {
+        cum += counts[i];
+        if (cum >= rank) {return i;}
+    }
+    return counts.size() - 1;
+}
+
+void Histogram::write(std::ostream &out) const {
+    int n_bins = 0;
+    for (auto c : counts) {n_bins += c != 0;}
+    out << n << " " << sum << " " << counts.size() << " " << n_bins;
+    for (int i = 0; i < counts.size(); i++) {
+        if (counts[i] != 0) {out << " " << i << " " << counts[i];}
+    }
+    out << "\n";
+}
+
+void Histogram::read(std::istream &in){
+    long size = 0;
+    int n_bins = 0;
+    in >> n >> sum >> size >> n_bins;
+    counts.assign(size, 0);
+    for (int b = 0; b < n_bins; b++) {
+        long i = 0;
+        long c = 0;
+        in >> i >> c;
+        if (i < 0 || i >= size) {throw std::runtime_error("Corrupt histogram");}
+        counts[i] = c;
+    }
+}
+
+// PathwayStatistics methods
+void PathwayStatistics::merge(const PathwayStatistics &other){
+    n_discharged += other.n_discharged;
+    n_completed += other.n_completed;
+    n_aged_out += other.n_aged_out;
+    n_waitlist_age_out += other.n_waitlist_age_out;
+    n_treated += other.n_treated;
+    sum_pct_face += other.sum_pct_face;
+    wait.merge(other.wait);
+    sojourn.merge(other.sojourn);
+    n_appts.merge(other.n_appts);
+}
+
+double PathwayStatistics::age_out_rate() const {
+    if (n_discharged == 0) {return std::numeric_limits<double>::quiet_NaN();}
+    return double(n_aged_out) / n_discharged;
+}
+
+double PathwayStatistics::mean_pct_face() const {
+    if (n_treated == 0) {return std::numeric_limits<double>::quiet_NaN();}
+    return sum_pct_face / n_treated;
+}
+
+// RunStatistics methods
+RunStatistics::RunStatistics(){}
+
+RunStatistics::RunStatistics(int warmup){
+    RunStatistics::set_warmup(warmup);
+}
+
+void RunStatistics::set_warmup(int w){warmup = w;}
+
+int RunStatistics::n_pathways() const {return pathways.size();}
+
+PathwayStatistics& RunStatistics::pathway(int p){
+    if (p >= pathways.size()) {
+        pathways.resize(p + 1);
+    }
+    return pathways[p];
+}
+
+const PathwayStatistics& RunStatistics::pathway(int p) const {return pathways.at(p);}
+
+void RunStatistics::add_patient(Patient &patient){
+    RunStatistics::add_discharge(patient.get_pathway(), patient.get_arrival_t(),
+                                patient.get_total_wait_time(), patient.get_sojourn_time(),
+                                patient.get_n_appts(), patient.get_modality_sum(),
+                                patient.get_age_out() == 1, false);
+}
+
+// the wait of a waitlist age-out is its time to age out
+void RunStatistics::add_aged_out(const WaitlistEntry &entry, int epoch){
+    RunStatistics::add_discharge(entry.pathway, entry.arrival_time, epoch - entry.arrival_time,
+                                epoch - entry.arrival_time, 0, 0, true, true);
+}
+
+void RunStatistics::add_discharge(int pathway, int arrival_t, int wait, int sojourn, int n_appts,
+                                int modality_sum, bool age_out, bool waitlist_age_out){
+    if (arrival_t < warmup) {return;}
+    PathwayStatistics &ps = RunStatistics::pathway(pathway);
+    ps.n_discharged += 1;
+    if (age_out) {
+        ps.n_aged_out += 1;
+    } else {
+        ps.n_completed += 1;
+    }
+    if (waitlist_age_out) {ps.n_waitlist_age_out += 1;}
+    ps.wait.add(wait);
+    ps.sojourn.add(sojourn);
+    ps.n_appts.add(n_appts);
+    if (n_appts > 0) {
+        ps.n_treated += 1;
+        ps.sum_pct_face += float(modality_sum)/float(n_appts);
+    }
+}
+
+void RunStatistics::merge(const RunStatistics &other){
+    for (int p = 0; p < other.n_pathways(); p++) {
+        RunStatistics::pathway(p).merge(other.pathway(p));
+    }
+    n_arrivals += other.n_arrivals;
+    n_discharged += other.n_discharged;
+    n_waitlist += other.n_waitlist;
+    epochs_run += other.epochs_run;
+    stable = stable && other.stable;
+}
+
+std::vector<std::pair<std::string, double>> RunStatistics::summary() const {
+    std::vector<std::pair<std::string, double>> rows;
+    rows.push_back({"n_arrivals", double(n_arrivals)});
+    rows.push_back({"n_discharged", double(n_discharged)});
+    rows.push_back({"n_waitlist", double(n_waitlist)});
+    rows.push_back({"epochs_run", double(epochs_run)});
+    rows.push_back({"stable", double(stable)});
+    for (int p = 0; p < pathways.size(); p++) {
+        const PathwayStatistics &ps = pathways[p];
+        std::string sfx = "_" + std::to_string(p);
+        rows.push_back({"n_discharged" + sfx, double(ps.n_discharged)});
+        rows.push_back({"age_out_rate" + sfx, ps.age_out_rate()});
+        rows.push_back({"wait_mean" + sfx, ps.wait.mean()});
+        rows.push_back({"wait_p50" + sfx, ps.wait.quantile(0.5)});
+        rows.push_back({"wait_p90" + sfx, ps.wait.quantile(0.9)});
+        rows.push_back({"sojourn_mean" + sfx, ps.sojourn.mean()});
+        rows.push_back({"n_appts_mean" + sfx, ps.n_appts.mean()});
+        rows.push_back({"pct_face_mean" + sfx, ps.mean_pct_face()});
+    }
+    rows.insert(rows.end(), memory.begin(), memory.end());
+    return rows;
+}
+
+void RunStatistics::save(std::string path) const {
+    std::ofstream out(path);
+    if (!out) {throw std::runtime_error("Could not write statistics to " + path);}
+    out << std::setprecision(17);
+    out << "run_statistics 1\n";
+    out << n_arrivals << " " << n_discharged << " " << n_waitlist << " "
+        << epochs_run << " " << stable << " " << warmup << " " << pathways.size() << "\n";
+    for (auto & ps : pathways) {
+        out << ps.n_discharged << " " << ps.n_completed << " " << ps.n_aged_out << " "
+            << ps.n_waitlist_age_out << " " << ps.n_treated << " " << ps.sum_pct_face << "\n";
+        ps.wait.write(out);
+        ps.sojourn.write(out);
+        ps.n_appts.write(out);
+    }
+}
+
+RunStatistics RunStatistics::load(std::string path){
+    std::ifstream in(path);
+    std::string tag;
+    int version = 0;
+    in >> tag >> version;
+    if (!in || tag != "run_statistics" || version != 1) {
+        throw std::runtime_error("Not a statistics file: " + path);
+    }
+    RunStatistics stats;
+    int n_pathways = 0;
+    in >> stats.n_arrivals >> stats.n_discharged >> stats.n_waitlist
+        >> stats.epochs_run >> stats.stable >> stats.warmup >> n_pathways;
+    for (int p = 0; p < n_pathways; p++) {
+        PathwayStatistics &ps = stats.pathway(p);
+        in >> ps.n_discharged >> ps.n_completed >> ps.n_aged_out
+            >> ps.n_waitlist_age_out >> ps.n_treated >> ps.sum_pct_face;
+        ps.wait.read(in);
+        ps.sojourn.read(in);
+        ps.n_appts.read(in);
+    }
+    if (!in) {throw std::runtime_error("Truncated statistics file: " + path);}
+    return stats;
+}
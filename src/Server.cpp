@@ -1,22 +1,41 @@
 #include "Server.h"
-#include <deque>
+#include <vector>
 #include "Patient.h"
 #include "Waitlist.h"
 #include "DischargeList.h"
+#include "Invariants.h"
 
-Server::Server(Waitlist &wl, DischargeList &dl) : waitlist(wl), discharge_list(dl) {}
+Server::Server(Waitlist &wl, DischargeList &dl) : waitlist(wl), discharge_list(dl) {
+    set_max_caseload(max_caseload);
+}
 
 Server::Server(int max_caseload, Waitlist &wl, DischargeList &dl) : waitlist(wl), discharge_list(dl) {
     set_max_caseload(max_caseload);
 }
 
+Server::Server(const Server &other, Waitlist &wl, DischargeList &dl)
+    : caseload(other.caseload), order(other.order), cursor(other.cursor),
+    waitlist(wl), discharge_list(dl), max_caseload(other.max_caseload),
+    logging(other.logging), next_free(other.next_free),
+    utilisation(nullptr), first_slot(other.first_slot) {}
+
 void Server::add_patient(Patient &patient) {
-    caseload.push_back(patient);
-    n_patients += 1;
-    if (caseload.size() > n_patients){
-        std::cout << "Caseload size: " << caseload.size() << " n_patients: " << n_patients << std::endl;
-        throw std::runtime_error("Error - Line 13");
-    }
+    int slot = 0;
+    while (slot < caseload.size() && caseload[slot].has_value()) {slot++;}
+    SIM_INVARIANT(slot < caseload.size(), "patient added to a full caseload");
+    caseload[slot].emplace(patient);
+    order.insert(order.begin() + cursor, slot);
+    cursor = (cursor + 1) % order.size();
+}
+
+Patient& Server::patient_at(int i){
+    return *caseload[order[(cursor + i) % order.size()]];
+}
+
+void Server::remove_current(){
+    caseload[order[cursor]].reset();
+    order.erase(order.begin() + cursor);
+    if (cursor == order.size()) {cursor = 0;}
 }
 
 void Server::add_from_waitlist(int epoch){
@@ -31,47 +50,75 @@ void Server::add_from_waitlist(int epoch){
 
 void Server::process_extension(Patient patient, int epoch){
     waitlist.add_patient(patient, epoch);
-    n_patients -= 1;
 }
 
+void Server::reseed_patients(std::mt19937 &gen){
+    for (auto & slot : caseload) {
+        if (slot.has_value()) {slot->rng.seed(gen());}
+    }
+}
+
+bool Server::has_capacity(){return order.size() < max_caseload;}
+
+int Server::get_n_patients(){return order.size();}
+
+// order lists each occupied slot exactly once and the cursor points into it
+void Server::check_invariants(){
+    SIM_INVARIANT(caseload.size() == max_caseload, "caseload slots resized");
+    SIM_INVARIANT(order.size() <= max_caseload, "caseload over capacity");
+    SIM_INVARIANT(order.size() == 0 ? cursor == 0 : cursor < order.size(), "cursor out of range");
+    int n_occupied = 0;
+    for (auto & slot : caseload) {n_occupied += slot.has_value();}
+    SIM_INVARIANT(n_occupied == order.size(), "occupied slots do not match the visit order");
+    for (auto i : order) {
+        SIM_INVARIANT(i >= 0 && i < caseload.size() && caseload[i].has_value(), "visit order names an empty slot");
+    }
+}
+
+// admissions happen beforehand in Simulation::admit_patients
 void Server::process_epoch(int epoch){
-    // std::cout << "Processing epoch. n_patients: " << n_patients << " Caseload len: " << caseload.size() << std::endl;
     int capacity = 1;
-    if (n_patients < max_caseload) {
-        if (caseload.size() > n_patients) {
-            std::cout << "Caseload size: " << caseload.size() << " n_patients: " << n_patients << std::endl;
-            throw std::runtime_error("Error - Line 38");
-        }
-        add_from_waitlist(epoch);
-    }
-    while (capacity > 0 & n_patients > 0) {
-        Patient p = caseload.front();
-        caseload.pop_front();
+    while (capacity > 0 && order.size() > 0) {
+        Patient &p = Server::patient_at(0);
         std::array<int, 2> results = p.process_patient(epoch);
+        discharge_list.add_appointment(p, epoch);
         capacity -= results[0];
-        if (results[1] == 1 | results[1] == 2) { // if they have reached their service_max
+        if (utilisation && results[0] == 1) {
+            utilisation->mark(UtilisationLog::INDIVIDUAL, first_slot, p.get_pathway(), p.get_last_outcome());
+        }
+        if (results[1] == 1 || results[1] == 2) { // if they have reached their service_max
             p.set_discharge_time(epoch);
             discharge_list.add_patient(p);
-            n_patients -= 1;
+            Server::remove_current();
         } else {
-            caseload.push_back(p);
-            if (caseload.size() > n_patients) {
-                std::cout << "Caseload size: " << caseload.size() << " n_patients: " << n_patients << std::endl;
-                throw std::runtime_error("Error - Line 84");
-            }
+            cursor = (cursor + 1) % order.size();
         }
-        // std::cout << "Capacity: " << capacity << std::endl;
     }
 }
 
 // member variable setter methods
-void Server::set_max_caseload(int max){max_caseload=max;}
+// only while the caseload is empty
+void Server::set_max_caseload(int max){
+    max_caseload = max;
+    caseload.clear();
+    caseload.resize(max_caseload);
+    order.reserve(max_caseload);
+}
+void Server::set_next_free(int next){next_free=next;}
+void Server::set_utilisation_log(UtilisationLog *log, int first){
+    utilisation = log;
+    first_slot = first;
+}
+
+// member variable getter methods
+int Server::get_next_free(){return next_free;}
+int Server::get_max_caseload(){return max_caseload;}
 
 // logging methods
 void Server::print_patients() {
-    if (caseload.size() > 0) {
-        for (auto p : caseload) {
-            std::cout << p.get_total_wait_time();
+    if (order.size() > 0) {
+        for (int i = 0; i < order.size(); i++) {
+            std::cout << Server::patient_at(i).get_total_wait_time();
         }
     } else if (logging) {
         std::cout << "No patients on caseload.";
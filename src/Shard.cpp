@@ -0,0 +1,108 @@
+#include "Shard.h"
+
+#include <iostream>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include "RunStatistics.h"
+#include "StatUtils.h"
+#include "DatasetWriter.h"
+#include "WriteCSV.h"
+
+ShardSpec ShardSpec::parse(std::string spec){
+    ShardSpec shard;
+    size_t slash = spec.find('/');
+    try {
+        if (slash == std::string::npos) {throw std::invalid_argument(spec);}
+        shard.index = std::stoi(spec.substr(0, slash));
+        shard.count = std::stoi(spec.substr(slash + 1));
+    } catch (const std::logic_error &e) {
+        throw std::runtime_error("Shard must be given as i/N: " + spec);
+    }
+    if (shard.count < 1 || shard.index < 0 || shard.index >= shard.count) {
+        throw std::runtime_error("Shard index out of range: " + spec);
+    }
+    return shard;
+}
+
+// offset by scenario so small run counts spread across shards for every scenario
+bool ShardSpec::owns(int scenario_id, int run, int block_size) const {
+    long job = long(scenario_id) + run / block_size;
+    return ((job % count) + count) % count == index;
+}
+
+bool ShardSpec::is_sharded() const {return count > 1;}
+
+namespace {
+    // run index from "stats_<run>.txt", -1 for other files
+    int stats_run(const std::string &name){
+        const std::string prefix = "stats_";
+        const std::string ext = ".txt";
+        if (name.size() <= prefix.size() + ext.size() || name.rfind(prefix, 0) != 0
+            || name.compare(name.size() - ext.size(), ext.size(), ext) != 0) {
+            return -1;
+        }
+        try {
+            return std::stoi(name.substr(prefix.size(), name.size() - prefix.size() - ext.size()));
+        } catch (const std::logic_error &e) {
+            return -1;
+        }
+    }
+
+    void merge_statistics(std::string dir, const std::map<int, std::string> &files, double confidence){
+        RunStatistics pooled;
+        std::map<std::string, std::vector<double>> per_run;
+        std::vector<std::string> keys;  // first-seen order of the per-run summary columns
+        for (auto & kv : files) {
+            RunStatistics stats = RunStatistics::load(kv.second);
+            pooled.merge(stats);
+            for (auto & row : stats.summary()) {
+                if (per_run.find(row.first) == per_run.end()) {keys.push_back(row.first);}
+                per_run[row.first].push_back(row.second);
+            }
+        }
+        std::vector<std::pair<std::string, double>> rows;
+        rows.push_back({"runs", double(files.size())});
+        for (auto & row : pooled.summary()) {
+            rows.push_back({"pooled_" + row.first, row.second});
+        }
+        for (auto & key : keys) {
+            ConfidenceInterval ci = stat_utils::mean_ci(per_run[key], confidence);
+            rows.push_back({key + "_mean", ci.mean});
+            rows.push_back({key + "_lower", ci.lower});
+            rows.push_back({key + "_upper", ci.upper});
+        }
+        write_csv(dir + "summary_merged.csv", rows);
+        std::cout << "Merged " << files.size() << " runs into " << dir << "summary_merged.csv" << std::endl;
+    }
+}
+
+void merge_shards(std::vector<std::string> inputs, std::string folder, double confidence){
+    namespace fs = std::filesystem;
+    fs::create_directories(folder);
+    for (auto & input : inputs) {
+        if (input.empty()) {continue;}
+        if (!fs::is_directory(input)) {
+            throw std::runtime_error("Merge input is not a directory: " + input);
+        }
+        if (fs::equivalent(input, folder)) {continue;}
+        fs::copy(input, folder, fs::copy_options::recursive | fs::copy_options::overwrite_existing);
+    }
+
+    // group statistics files by directory (one per scenario in the hive layout)
+    std::map<std::string, std::map<int, std::string>> by_dir;
+    for (auto & entry : fs::recursive_directory_iterator(folder)) {
+        if (!entry.is_regular_file()) {continue;}
+        int run = stats_run(entry.path().filename().string());
+        if (run < 0) {continue;}
+        std::string dir = entry.path().parent_path().string() + "/";
+        by_dir[dir][run] = entry.path().string();
+    }
+    if (by_dir.empty()) {
+        throw std::runtime_error("No run statistics found under " + folder);
+    }
+    for (auto & kv : by_dir) {
+        merge_statistics(kv.first, kv.second, confidence);
+    }
+    DatasetWriter::consolidate(folder + "discharges/");
+}
@@ -0,0 +1,145 @@
+#include "Splitting.h"
+
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include "DischargeList.h"
+#include "Waitlist.h"
+#include "Simulation.h"
+#include "WriteCSV.h"
+#include "Replication.h"
+
+// one independent copy of the simulation; discharges only feed in-memory statistics
+struct Splitting::Trajectory{
+    DischargeList dl;
+    Waitlist wl;
+    Simulation sim;
+    int epoch = 0;
+
+    Trajectory(SimConfig &cfg, std::mt19937 &wl_gen)
+        : dl(), wl(cfg.pathways.size(), cfg.max_ax_age, cfg.priority_wlist, cfg.p_order, wl_gen, dl),
+        sim(make_simulation(cfg, dl, wl)) {
+        wl.set_selection_policy(cfg.wl_policy, cfg.fair_weights);
+    }
+};
+
+Splitting::Splitting(SimConfig cfg, int pathway, std::vector<int> levels, int horizon,
+                    int effort, double confidence) : cfg(cfg), pathway(pathway), levels(levels),
+                    horizon(horizon), effort(effort), confidence(confidence) {
+    if (pathway < 0 || pathway >= cfg.pathways.size()) {
+        throw std::runtime_error("Splitting pathway out of range");
+    }
+    if (!cfg.arrival_trace.empty()) {
+        throw std::runtime_error("Splitting needs sampled arrivals, a trace cannot be cloned");
+    }
+    if (levels.empty() || horizon < 1 || effort < 1) {
+        throw std::runtime_error("Splitting needs levels, a positive horizon and effort");
+    }
+    for (int k = 1; k < levels.size(); k++) {
+        if (levels[k] <= levels[k - 1]) {
+            throw std::runtime_error("Splitting levels must be strictly increasing");
+        }
+    }
+}
+
+std::unique_ptr<Splitting::Trajectory> Splitting::make_trajectory(std::mt19937 &wl_gen){
+    return std::make_unique<Trajectory>(cfg, wl_gen);
+}
+
+std::unique_ptr<Splitting::Trajectory> Splitting::clone(const Trajectory &source, std::mt19937 &gen){
+    std::unique_ptr<Trajectory> t = Splitting::make_trajectory(gen);
+    t->sim.copy_state(source.sim);
+    t->sim.reseed(gen);
+    t->epoch = source.epoch;
+    return t;
+}
+
+// steps t until its pathway queue reaches level (true) or end_epoch (false)
+bool Splitting::advance(Trajectory &t, int level, int end_epoch){
+    while (t.wl.waitlist[pathway].size() < level) {
+        if (t.epoch >= end_epoch) {return false;}
+        t.sim.step(t.epoch);
+        t.epoch += 1;
+        epochs_simulated += 1;
+    }
+    return true;
+}
+
+double Splitting::estimate(int rep){
+    // the start state is the one run_replication would reach after the warm-up
+    std::seed_seq wl_seq{cfg.seed, (unsigned int) rep, 0u};
+    std::seed_seq sim_seq{cfg.seed, (unsigned int) rep, 1u};
+    std::seed_seq split_seq{cfg.seed, (unsigned int) rep, 2u};
+    std::mt19937 wl_gen(wl_seq);
+    std::mt19937 sim_gen(sim_seq);
+    std::mt19937 split_gen(split_seq);
+
+    std::unique_ptr<Trajectory> start = Splitting::make_trajectory(wl_gen);
+    start->sim.set_rng(sim_gen);
+    start->sim.generate_servers();
+    start->sim.prefill_waitlist(cfg.waitlist_prefill);
+    for (; start->epoch < cfg.warmup; start->epoch++) {start->sim.step(start->epoch);}
+    epochs_simulated += cfg.warmup;
+    int end_epoch = cfg.warmup + horizon;
+
+    std::vector<std::unique_ptr<Trajectory>> entrance;
+    entrance.push_back(std::move(start));
+    double p = 1;
+    stage_probs.push_back({});
+    for (int k = 0; k < levels.size(); k++) {
+        std::vector<std::unique_ptr<Trajectory>> hits;
+        for (int i = 0; i < effort; i++) {
+            std::unique_ptr<Trajectory> t = Splitting::clone(*entrance[i % entrance.size()], split_gen);
+            if (Splitting::advance(*t, levels[k], end_epoch)) {hits.push_back(std::move(t));}
+        }
+        double p_k = double(hits.size()) / effort;
+        stage_probs.back().push_back(p_k);
+        p *= p_k;
+        if (hits.empty()) {break;}
+        entrance = std::move(hits);
+    }
+    stage_probs.back().resize(levels.size(), 0);
+    return p;
+}
+
+ConfidenceInterval Splitting::run(){
+    for (int rep = 0; rep < cfg.runs; rep++) {
+        estimates.push_back(Splitting::estimate(rep));
+        std::cout << "Splitting repetition " << rep << ": " << estimates.back() << std::endl;
+    }
+    result = stat_utils::mean_ci(estimates, confidence);
+    std::cout << "P(waitlist " << pathway << " >= " << levels.back() << " within " << horizon
+            << " epochs) = " << result.mean << " [" << result.lower << ", " << result.upper << "]"
+            << " from " << epochs_simulated << " epochs" << std::endl;
+    return result;
+}
+
+void Splitting::write_results(std::string path){
+    if (estimates.empty()) {
+        throw std::runtime_error("Splitting has not been run");
+    }
+    std::vector<std::pair<std::string, double>> dataset;
+    dataset.push_back({"pathway", double(pathway)});
+    dataset.push_back({"threshold", double(levels.back())});
+    dataset.push_back({"horizon", double(horizon)});
+    dataset.push_back({"effort", double(effort)});
+    dataset.push_back({"reps", double(estimates.size())});
+    dataset.push_back({"probability", result.mean});
+    dataset.push_back({"lower", result.lower});
+    dataset.push_back({"upper", result.upper});
+    double var = estimates.size() > 1 ? stat_utils::variance(estimates) : NAN;
+    dataset.push_back({"variance", var});
+    dataset.push_back({"relative_error", std::sqrt(var / estimates.size()) / result.mean});
+    for (int k = 0; k < levels.size(); k++) {
+        double mean_p = 0;
+        for (auto & rep : stage_probs) {mean_p += rep[k];}
+        dataset.push_back({"level_" + std::to_string(k), double(levels[k])});
+        dataset.push_back({"stage_prob_" + std::to_string(k), mean_p / stage_probs.size()});
+    }
+    dataset.push_back({"epochs_simulated", double(epochs_simulated)});
+    // epochs plain Monte Carlo would need for the same relative error
+    double p = result.mean;
+    double mc_runs = var / estimates.size() > 0 ? p * (1 - p) / (var / estimates.size()) : NAN;
+    dataset.push_back({"mc_epochs_equivalent", mc_runs * (cfg.warmup + horizon)});
+    write_csv(path, dataset);
+}
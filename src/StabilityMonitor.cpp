@@ -0,0 +1,67 @@
+#include "StabilityMonitor.h"
+
+#include <cmath>
+#include <vector>
+#include "StatUtils.h"
+
+StabilityMonitor::StabilityMonitor(){}
+
+StabilityMonitor::StabilityMonitor(int window, int min_windows, double alpha, double tolerance) :
+                                window(window), min_windows(min_windows), alpha(alpha),
+                                tolerance(tolerance) {}
+
+void StabilityMonitor::record(int waitlist_len, long n_arrivals, long n_admissions){
+    window_wl_sum += waitlist_len;
+    window_arrivals += n_arrivals - last_arrivals;
+    window_admissions += n_admissions - last_admissions;
+    last_arrivals = n_arrivals;
+    last_admissions = n_admissions;
+    n_in_window += 1;
+    if (n_in_window < window) {return;}
+
+    wl_means.push_back(window_wl_sum / window);
+    arrivals.push_back(window_arrivals);
+    admissions.push_back(window_admissions);
+    n_in_window = 0;
+    window_wl_sum = 0;
+    window_arrivals = 0;
+    window_admissions = 0;
+    StabilityMonitor::evaluate();
+}
+
+void StabilityMonitor::evaluate(){
+    int n = min_windows;
+    if (wl_means.size() < n) {return;}
+    int first = wl_means.size() - n;
+
+    // Mann-Kendall S statistic on the window means
+    double s = 0;
+    for (int i = first; i < wl_means.size(); i++) {
+        for (int j = i + 1; j < wl_means.size(); j++) {
+            s += (wl_means[j] > wl_means[i]) - (wl_means[j] < wl_means[i]);
+        }
+    }
+    double var = n * (n - 1.0) * (2.0 * n + 5) / 18;
+    trend_z = s > 0 ? (s - 1) / sqrt(var) : (s < 0 ? (s + 1) / sqrt(var) : 0);
+
+    long arr = 0;
+    long adm = 0;
+    bool sustained = true;
+    for (int i = first; i < arrivals.size(); i++) {
+        arr += arrivals[i];
+        adm += admissions[i];
+        if (arrivals[i] == 0 || arrivals[i] - admissions[i] <= tolerance * arrivals[i]) {
+            sustained = false;
+        }
+    }
+    deficit = arr > 0 ? double(arr - adm) / arr : 0;
+
+    bool trend = trend_z > stat_utils::normal_quantile(1 - alpha);
+    unstable = deficit > tolerance && (trend || sustained);
+}
+
+bool StabilityMonitor::is_unstable(){return unstable;}
+
+double StabilityMonitor::get_trend_z(){return trend_z;}
+
+double StabilityMonitor::get_deficit(){return deficit;}
@@ -0,0 +1,94 @@
+#include "StatUtils.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Acklam's rational approximation to the inverse normal CDF (rel. error < 1.2e-9)
+double stat_utils::normal_quantile(double p){
+    static const double a[6] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[5] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[4] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00};
+    const double p_low = 0.02425;
+
+    if (p <= 0) {return -std::numeric_limits<double>::infinity();}
+    if (p >= 1) {return std::numeric_limits<double>::infinity();}
+    if (p < p_low) {
+        double q = sqrt(-2 * log(p));
+        return (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+                ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+    } else if (p <= 1 - p_low) {
+        double q = p - 0.5;
+        double r = q * q;
+        return (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q /
+                (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+    } else {
+        double q = sqrt(-2 * log(1 - p));
+        return -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+                ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+    }
+}
+
+// exact for df = 1, 2; Cornish-Fisher expansion (A&S 26.7.5) otherwise
+double stat_utils::t_quantile(int df, double p){
+    if (df < 1) {return std::numeric_limits<double>::quiet_NaN();}
+    if (df == 1) {return tan(M_PI * (p - 0.5));}
+    if (df == 2) {return (2*p - 1) / sqrt(2 * p * (1 - p));}
+    double z = normal_quantile(p);
+    double z2 = z * z;
+    double v = df;
+    double g1 = (z2 + 1) * z / 4;
+    double g2 = ((5*z2 + 16)*z2 + 3) * z / 96;
+    double g3 = (((3*z2 + 19)*z2 + 17)*z2 - 15) * z / 384;
+    double g4 = ((((79*z2 + 776)*z2 + 1482)*z2 - 1920)*z2 - 945) * z / 92160;
+    return z + g1/v + g2/(v*v) + g3/(v*v*v) + g4/(v*v*v*v);
+}
+
+double stat_utils::mean(const std::vector<double> &xs){
+    double sum = 0;
+    int n = 0;
+    for (double x : xs) {
+        if (std::isnan(x)) {continue;}
+        sum += x;
+        n += 1;
+    }
+    if (n == 0) {return std::numeric_limits<double>::quiet_NaN();}
+    return sum / n;
+}
+
+double stat_utils::variance(const std::vector<double> &xs){
+    double m = stat_utils::mean(xs);
+    double ss = 0;
+    int n = 0;
+    for (double x : xs) {
+        if (std::isnan(x)) {continue;}
+        ss += (x - m) * (x - m);
+        n += 1;
+    }
+    if (n < 2) {return std::numeric_limits<double>::quiet_NaN();}
+    return ss / (n - 1);
+}
+
+ConfidenceInterval stat_utils::mean_ci(const std::vector<double> &xs, double confidence){
+    ConfidenceInterval ci;
+    ci.n = 0;
+    for (double x : xs) {
+        if (!std::isnan(x)) {ci.n += 1;}
+    }
+    ci.mean = stat_utils::mean(xs);
+    if (ci.n < 2) {
+        ci.lower = -std::numeric_limits<double>::infinity();
+        ci.upper = std::numeric_limits<double>::infinity();
+        return ci;
+    }
+    double half = stat_utils::t_quantile(ci.n - 1, 0.5 + confidence / 2)
+                    * sqrt(stat_utils::variance(xs) / ci.n);
+    ci.lower = ci.mean - half;
+    ci.upper = ci.mean + half;
+    return ci;
+}
@@ -0,0 +1,87 @@
+#include "UtilisationLog.h"
+
+#include <iostream>
+#include <stdexcept>
+#include "arrow/io/file.h"
+#include "parquet/api/writer.h"
+#include "Reader_Writer.h"
+#include "Invariants.h"
+
+UtilisationLog::UtilisationLog(std::string path, int n_pathways, int individual_slots, int group_slots,
+                            int batch_epochs) : n_pathways(n_pathways), batch_epochs(batch_epochs) {
+    PARQUET_ASSIGN_OR_THROW(
+        outfile,
+        arrow::io::FileOutputStream::Open(path));
+    writer = parquet::ParquetFileWriter::Open(outfile, SetupSchema_Utilisation(),
+                                            UtilisationWriterProperties());
+    capacity[INDIVIDUAL] = individual_slots;
+    capacity[GROUP] = group_slots;
+    for (int t = 0; t < N_SERVER_TYPES; t++) {
+        words_per_type[t] = (capacity[t] + 63) / 64;
+        words[t].assign(n_pathways * IDLE * words_per_type[t], 0);
+    }
+    totals.assign(N_SLOT_STATES, 0);
+}
+
+UtilisationLog::~UtilisationLog(){
+    try {
+        UtilisationLog::close();
+    } catch (const std::exception &e) {
+        std::cout << "Failed to close utilisation log: " << e.what() << std::endl;
+    }
+}
+
+void UtilisationLog::add_row(int epoch, int type, int pathway, int state, int n){
+    epochs.push_back(epoch);
+    server_types.push_back(type);
+    pathways.push_back(pathway);
+    states.push_back(state);
+    slots.push_back(n);
+    capacities.push_back(capacity[type]);
+    totals[state] += n;
+}
+
+void UtilisationLog::end_epoch(int epoch){
+    for (int t = 0; t < N_SERVER_TYPES; t++) {
+        if (capacity[t] == 0) {continue;}
+        int used = 0;
+        for (int p = 0; p < n_pathways; p++) {
+            for (int s = 0; s < IDLE; s++) {
+                const uint64_t *bits = &words[t][(p * IDLE + s) * words_per_type[t]];
+                int n = 0;
+                for (int w = 0; w < words_per_type[t]; w++) {n += __builtin_popcountll(bits[w]);}
+                used += n;
+                UtilisationLog::add_row(epoch, t, p, s, n);
+            }
+        }
+        SIM_INVARIANT(used <= capacity[t], "slot marked more than once in an epoch");
+        UtilisationLog::add_row(epoch, t, -1, IDLE, capacity[t] - used);
+        std::fill(words[t].begin(), words[t].end(), 0);
+    }
+    epochs_buffered += 1;
+    if (epochs_buffered >= batch_epochs) {UtilisationLog::flush();}
+}
+
+// one row group per batch of epochs, written column by column
+void UtilisationLog::flush(){
+    epochs_buffered = 0;
+    if (epochs.size() == 0) {return;}
+    int64_t n = epochs.size();
+    parquet::RowGroupWriter *rg = writer->AppendRowGroup();
+    for (auto *column : {&epochs, &server_types, &pathways, &states, &slots, &capacities}) {
+        auto *w = static_cast<parquet::Int32Writer*>(rg->NextColumn());
+        w->WriteBatch(n, nullptr, nullptr, column->data());
+        column->clear();
+    }
+    rg->Close();
+}
+
+void UtilisationLog::close(){
+    if (!writer) {return;}
+    UtilisationLog::flush();
+    writer->Close();
+    writer.reset();
+    PARQUET_THROW_NOT_OK(outfile->Close());
+}
+
+long UtilisationLog::get_slots(int state){return totals[state];}
@@ -4,24 +4,32 @@
 #include <vector>
 #include <deque>
 #include <algorithm>
+#include <stdexcept>
 #include "Patient.h"
 #include "DischargeList.h"
+#include "Invariants.h"
 
 // Waitlist::Waitlist(){};
 
 Waitlist::Waitlist(int n_classes, double max_ax_age, 
                 std::mt19937 &gen, DischargeList& dl) : discharge_list(dl) {
+    if (n_classes > 64) {
+        throw std::runtime_error("Waitlist supports at most 64 classes");
+    }
     rng = gen;
     set_max_ax_age(max_ax_age);
     for (int i = 0; i < n_classes; i++){
         classes.push_back(i);
-        waitlist.push_back(std::deque<std::pair<Patient, int>>());
+        waitlist.push_back(tracked_deque<WaitlistEntry, memory_tracker::WAITLIST>());
     }
 }
 
 Waitlist::Waitlist(int n_classes, double max_ax_age, 
                 bool priority_wlist, std::vector<int> (&p_order),
                 std::mt19937 &gen, DischargeList& dl) : priority_order(p_order), discharge_list(dl) {
+    if (n_classes > 64) {
+        throw std::runtime_error("Waitlist supports at most 64 classes");
+    }
     rng = gen;
     set_max_ax_age(max_ax_age);
     set_priority_wlist(priority_wlist);
@@ -31,13 +39,45 @@ Waitlist::Waitlist(int n_classes, double max_ax_age,
         } else {
             classes.push_back(i);
         }
-        waitlist.push_back(std::deque<std::pair<Patient, int>>());
+        waitlist.push_back(tracked_deque<WaitlistEntry, memory_tracker::WAITLIST>());
     }
 }
 
 // setter methods
 void Waitlist::set_max_ax_age(double m){max_ax_age = m;}
 void Waitlist::set_priority_wlist(bool p){priority_wlist = p;}
+void Waitlist::set_patient_factory(PatientFactory f){factory = f;}
+
+void Waitlist::set_selection_policy(std::string policy, std::vector<double> fair_weights){
+    if (policy == "priority" || policy == "random") {
+        // the scan order was fixed by priority_wlist at construction
+        if (priority_wlist != (policy == "priority")) {
+            throw std::runtime_error("Waitlist policy " + policy + " needs priority_wlist "
+                                    + (policy == "priority" ? "on" : "off"));
+        }
+        indexed = false;
+        return;
+    }
+    selector = ClassSelector(ClassSelector::parse(policy), waitlist.size(), fair_weights);
+    indexed = true;
+    for (int c = 0; c < waitlist.size(); c++) {Waitlist::head_changed(c);}
+}
+
+void Waitlist::copy_state(const Waitlist &other){
+    classes = other.classes;
+    waitlist = other.waitlist;
+    reassignment_list.clear();  // Patient is not assignable
+    for (auto & patient : other.reassignment_list) {reassignment_list.push_back(patient);}
+    rng = other.rng;
+    nonempty_mask = other.nonempty_mask;
+    n_admissions = other.n_admissions;
+    indexed = other.indexed;
+    selector = other.selector;
+}
+
+void Waitlist::head_changed(int c){
+    selector.on_head_changed(c, waitlist[c].empty() ? nullptr : &waitlist[c].front());
+}
 
 int Waitlist::len_waitlist(){
     int len = 0;
@@ -47,8 +87,44 @@ int Waitlist::len_waitlist(){
     return len;
 }
 
+bool Waitlist::is_empty(){return nonempty_mask == 0;}
+
+long Waitlist::get_n_admissions(){return n_admissions;}
+
 void Waitlist::add_patient(Patient &patient, int epoch){
-    waitlist[patient.get_pathway()].push_back((std::pair<Patient, int>) {patient, epoch});
+    WaitlistEntry entry = {patient.get_arrival_t(), patient.get_arrival_age(),
+                            (int16_t) patient.get_pathway(), (int16_t) patient.get_base_duration(),
+                            epoch};
+    Waitlist::add_entry(entry);
+}
+
+void Waitlist::add_entry(const WaitlistEntry &entry){
+    waitlist[entry.pathway].push_back(entry);
+    nonempty_mask |= uint64_t(1) << entry.pathway;
+    if (indexed && waitlist[entry.pathway].size() == 1) {Waitlist::head_changed(entry.pathway);}
+}
+
+void Waitlist::add_entries(const std::vector<WaitlistEntry> &entries){
+    uint64_t added = 0;
+    for (auto & entry : entries) {
+        waitlist[entry.pathway].push_back(entry);
+        added |= uint64_t(1) << entry.pathway;
+    }
+    // only classes that were empty get a new head
+    uint64_t new_heads = added & ~nonempty_mask;
+    nonempty_mask |= added;
+    if (!indexed) {return;}
+    for (int c = 0; new_heads != 0; c++, new_heads >>= 1) {
+        if (new_heads & 1) {Waitlist::head_changed(c);}
+    }
+}
+
+void Waitlist::pop_front(int c){
+    waitlist[c].pop_front();
+    if (waitlist[c].size() == 0) {
+        nonempty_mask &= ~(uint64_t(1) << c);
+    }
+    if (indexed) {Waitlist::head_changed(c);}
 }
 
 int Waitlist::len_reassignments(){
@@ -60,7 +136,18 @@ void Waitlist::add_reassignment(Patient patient){
 }
 
 bool Waitlist::check_availability(int epoch){
+    if (nonempty_mask == 0) {return false;}
+    if (indexed) {
+        // purge aged-out heads in selection order until the best head is admissible
+        for (int c = selector.top(); c >= 0; c = selector.top()) {
+            if (waitlist[c].front().get_age(epoch) < max_ax_age) {return true;}
+            discharge_list.add_aged_out(waitlist[c].front(), epoch);
+            Waitlist::pop_front(c);
+        }
+        return false;
+    }
     for (auto & i : classes){
+        if (!(nonempty_mask >> i & 1)) {continue;}
         bool ret_val = check_class_availability(i, epoch);
         if (ret_val){return true;}
     }
@@ -69,37 +156,75 @@ bool Waitlist::check_availability(int epoch){
 
 bool Waitlist::check_class_availability(int c, int epoch){
     while (waitlist[c].size() > 0) {
-        if (waitlist[c].front().first.get_age(epoch) < max_ax_age) {
+        if (waitlist[c].front().get_age(epoch) < max_ax_age) {
             return true;
         } else {
-            std::pair<Patient, int> pair = waitlist[c].front();
-            pair.first.set_discharge_time(epoch);
-            pair.first.set_age_out(1);
-            // std::cout << "Getting discharge list size: " << discharge_list.get_n_patients() << std::endl;
-            // std::cout << "Discharging patient from waitlist..." << std::endl;
-            discharge_list.add_patient(pair.first);
-            // std::cout << "Successfully discharged patient from waitlist." << std::endl;
-            waitlist[c].pop_front();
+            // aged out records go straight to the discharge output
+            discharge_list.add_aged_out(waitlist[c].front(), epoch);
+            Waitlist::pop_front(c);
         }
     }
     return false;
 }
 
+std::vector<std::pair<Patient, int>> Waitlist::get_class_patients(int c, int k, int epoch){
+    std::vector<std::pair<Patient, int>> cohort;
+    cohort.reserve(k);
+    while (cohort.size() < k && check_class_availability(c, epoch)) {
+        cohort.push_back(Waitlist::admit_front(c));
+    }
+    return cohort;
+}
+
+// builds the full patient for the entry at the front of class c
+std::pair<Patient, int> Waitlist::admit_front(int c){
+    WaitlistEntry entry = waitlist[c].front();
+    if (indexed) {selector.on_admit(c);}   // before the pop so the new head is keyed with it
+    Waitlist::pop_front(c);
+    int id = n_admissions;
+    n_admissions += 1;
+    return std::pair<Patient, int>(factory.make_patient(entry, rng, id), entry.epoch);
+}
+
 std::pair<Patient, int> Waitlist::get_patient(int epoch){
+    if (indexed) {return Waitlist::get_indexed_patient(epoch);}
     if (!priority_wlist) {
         std::shuffle(classes.begin(), classes.end(), rng);
     }
     for (auto & i : classes){
         if (waitlist[i].size() > 0){
-            std::pair<Patient, int> pair = waitlist[i].front();
-            waitlist[i].pop_front();
-            if (pair.first.get_age(epoch) > max_ax_age){
-                pair.first.set_discharge_time(epoch);
-                pair.first.set_age_out(1);
-                discharge_list.add_patient(pair.first);
+            if (waitlist[i].front().get_age(epoch) > max_ax_age){
+                discharge_list.add_aged_out(waitlist[i].front(), epoch);
+                Waitlist::pop_front(i);
             } else {
-                return pair;
+                return Waitlist::admit_front(i);
             }
         }
     }
+    // callers check availability first (Server::add_from_waitlist)
+    throw std::runtime_error("No patient available on the waitlist");
+}
+
+// O(log classes) per admission or age-out, whatever the policy
+std::pair<Patient, int> Waitlist::get_indexed_patient(int epoch){
+    for (int c = selector.top(); c >= 0; c = selector.top()) {
+        if (waitlist[c].front().get_age(epoch) > max_ax_age) {
+            discharge_list.add_aged_out(waitlist[c].front(), epoch);
+            Waitlist::pop_front(c);
+        } else {
+            return Waitlist::admit_front(c);
+        }
+    }
+    throw std::runtime_error("No patient available on the waitlist");
+}
+
+void Waitlist::check_invariants(){
+    if (indexed) {selector.check_invariants(nonempty_mask);}
+    for (int c = 0; c < waitlist.size(); c++) {
+        SIM_INVARIANT(bool(nonempty_mask >> c & 1) == (waitlist[c].size() > 0),
+                    "non-empty class mask out of sync");
+        for (auto & entry : waitlist[c]) {
+            SIM_INVARIANT(entry.pathway == c, "entry queued under the wrong class");
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,297 @@
+// equivalence: checks that an engine mode which changes the random draws
+// (e.g. the alias arrival sampler) still simulates the same model. A fixed
+// matrix of reference scenarios is run --runs times with the reference and the
+// candidate engine, on independent seeds. For every scenario, pathway and
+// per-run statistic (wait/sojourn/appointment means and quantiles, age-out
+// rate) the two sets of runs are compared with a two-sample KS test and the
+// Welch interval for the difference in means. Runs are independent while
+// discharges within a run are not, so the tests work on per-run values.
+// Bonferroni keeps the family-wise false alarm rate at --alpha.
+// Exits non-zero if any test rejects.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <cxxopts.hpp>
+
+#include "SimConfig.h"
+#include "Replication.h"
+#include "RunStatistics.h"
+#include "StatUtils.h"
+#include "ResultsCache.h"
+
+namespace {
+    struct Scenario{
+        std::string name;
+        SimConfig cfg;
+    };
+
+    // the reference matrix; changing it invalidates saved references
+    std::vector<Scenario> reference_scenarios(int n_epochs, int warmup){
+        SimConfig base;
+        base.n_epochs = n_epochs;
+        base.warmup = warmup;
+        std::vector<Scenario> scenarios;
+
+        scenarios.push_back({"baseline", base});
+
+        SimConfig congested = base;    // long waits and age-outs in the lower-priority pathways
+        congested.n_servers = 70;
+        scenarios.push_back({"congested", congested});
+
+        SimConfig groups = base;
+        groups.n_group_servers = {2, 2, 2};
+        groups.max_caseload = 2;
+        groups.wl_policy = "lwf";
+        scenarios.push_back({"groups", groups});
+
+        SimConfig prefill = base;
+        prefill.waitlist_prefill = 500;
+        prefill.wl_policy = "fair";
+        scenarios.push_back({"prefill_fair", prefill});
+        return scenarios;
+    }
+
+    // per-run statistics compared for each pathway
+    std::vector<std::pair<std::string, double>> run_statistics(const PathwayStatistics &ps){
+        return {{"wait_mean", ps.wait.mean()}, {"wait_p50", ps.wait.quantile(0.5)},
+                {"wait_p90", ps.wait.quantile(0.9)}, {"sojourn_mean", ps.sojourn.mean()},
+                {"sojourn_p50", ps.sojourn.quantile(0.5)}, {"sojourn_p90", ps.sojourn.quantile(0.9)},
+                {"n_appts_mean", ps.n_appts.mean()}, {"n_appts_p90", ps.n_appts.quantile(0.9)},
+                {"age_out_rate", ps.age_out_rate()}};
+    }
+
+    // pathways are only added to RunStatistics once they discharge someone
+    PathwayStatistics pathway_or_empty(const RunStatistics &stats, int p){
+        return p < stats.n_pathways() ? stats.pathway(p) : PathwayStatistics();
+    }
+
+    struct Comparison{
+        std::string scenario;
+        int pathway;
+        std::string statistic;
+        std::vector<double> reference;
+        std::vector<double> candidate;
+    };
+
+    // Q_KS(lambda) = 2 sum (-1)^(k-1) exp(-2 k^2 lambda^2)
+    double kolmogorov_q(double lambda){
+        if (lambda < 0.2) {return 1;}
+        double sum = 0;
+        for (int k = 1; k <= 100; k++) {
+            double term = 2 * (k % 2 ? 1 : -1) * std::exp(-2.0 * k * k * lambda * lambda);
+            sum += term;
+            if (std::fabs(term) < 1e-12) {break;}
+        }
+        return std::min(1.0, std::max(0.0, sum));
+    }
+
+    // two-sample KS statistic and p-value (asymptotic, Stephens' small-sample correction)
+    std::pair<double, double> ks_test(std::vector<double> a, std::vector<double> b){
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        double na = a.size(), nb = b.size();
+        int i = 0, j = 0;
+        double d = 0;
+        while (i < a.size() && j < b.size()) {
+            double x = std::min(a[i], b[j]);
+            while (i < a.size() && a[i] <= x) {i++;}
+            while (j < b.size() && b[j] <= x) {j++;}
+            d = std::max(d, std::fabs(i / na - j / nb));
+        }
+        double ne = std::sqrt(na * nb / (na + nb));
+        return {d, kolmogorov_q((ne + 0.12 + 0.11 / ne) * d)};
+    }
+
+    // Welch interval for mean(a) - mean(b)
+    ConfidenceInterval welch_ci(const std::vector<double> &a, const std::vector<double> &b, double confidence){
+        ConfidenceInterval ci;
+        ci.mean = stat_utils::mean(a) - stat_utils::mean(b);
+        ci.n = a.size() + b.size();
+        double va = stat_utils::variance(a) / a.size();
+        double vb = stat_utils::variance(b) / b.size();
+        double se = std::sqrt(va + vb);
+        if (se == 0) {
+            ci.lower = ci.upper = ci.mean;
+            return ci;
+        }
+        double df = (va + vb) * (va + vb) / (va * va / (a.size() - 1) + vb * vb / (b.size() - 1));
+        double half = stat_utils::t_quantile(std::max(1, int(df)), 0.5 + confidence / 2) * se;
+        ci.lower = ci.mean - half;
+        ci.upper = ci.mean + half;
+        return ci;
+    }
+
+    std::vector<double> finite(const std::vector<double> &xs){
+        std::vector<double> out;
+        for (double x : xs) {
+            if (std::isfinite(x)) {out.push_back(x);}
+        }
+        return out;
+    }
+
+    // what saved reference runs depend on: the run count and each scenario's
+    // results cache key, less the engine version and the run index
+    std::string reference_header(const std::vector<Scenario> &scenarios, int runs){
+        std::ostringstream header;
+        header << "runs=" << runs << "\n";
+        for (auto & scenario : scenarios) {
+            header << "scenario=" << scenario.name << "\n";
+            std::istringstream key(ResultsCache::config_key(scenario.cfg, 0));
+            std::string line;
+            while (std::getline(key, line)) {
+                if (line.rfind("engine=", 0) != 0 && line.rfind("run=", 0) != 0) {header << line << "\n";}
+            }
+        }
+        return header.str();
+    }
+
+    // refuses references saved with other runs, epochs, warmup, seed or scenarios
+    void check_reference_header(const std::string &dir, const std::string &expected){
+        std::ifstream in(dir + "/reference.txt");
+        if (!in) {throw std::runtime_error("No reference.txt in " + dir + ", save the references again");}
+        std::istringstream want(expected);
+        std::string saved_line, want_line;
+        int line_no = 0;
+        while (true) {
+            bool more_saved = bool(std::getline(in, saved_line));
+            bool more_want = bool(std::getline(want, want_line));
+            line_no += 1;
+            if (!more_saved && !more_want) {return;}
+            if (!more_saved || !more_want || saved_line != want_line) {
+                throw std::runtime_error("References in " + dir + " were saved with a different configuration (line "
+                                        + std::to_string(line_no) + ": saved \"" + (more_saved ? saved_line : "")
+                                        + "\", this run \"" + (more_want ? want_line : "") + "\")");
+            }
+        }
+    }
+
+    std::vector<RunStatistics> simulate(SimConfig cfg, int runs){
+        std::vector<RunStatistics> stats;
+        for (int run = 0; run < runs; run++) {stats.push_back(run_replication(cfg, run));}
+        return stats;
+    }
+}
+
+int main(int argc, char* argv[]){
+    cxxopts::Options options("equivalence", "Statistical equivalence of engine modes on reference scenarios");
+    options.add_options()
+        ("runs", "Independent runs per scenario and engine", cxxopts::value<int>()->default_value("20"))
+        ("n_epochs", "Epochs per run", cxxopts::value<int>()->default_value("1040"))
+        ("warmup", "Epochs excluded from the statistics", cxxopts::value<int>()->default_value("260"))
+        ("seed", "Seed of the reference runs; candidate runs use seed + 1", cxxopts::value<unsigned int>()->default_value("1"))
+        ("alpha", "Family-wise false alarm rate, split over all tests (Bonferroni)", cxxopts::value<double>()->default_value("0.05"))
+        ("reference_sampler", "Arrival sampler of the reference engine", cxxopts::value<std::string>()->default_value("reference"))
+        ("candidate_sampler", "Arrival sampler of the candidate engine", cxxopts::value<std::string>()->default_value("alias"))
+        ("save_reference", "Also save the reference runs' statistics under this directory", cxxopts::value<std::string>()->default_value(""))
+        ("reference_dir", "Load reference statistics saved by another build instead of simulating", cxxopts::value<std::string>()->default_value(""))
+        ("output", "Per-test results", cxxopts::value<std::string>()->default_value("equivalence.csv"))
+    ;
+    auto result = options.parse(argc, argv);
+    int runs = result["runs"].as<int>();
+    unsigned int seed = result["seed"].as<unsigned int>();
+    double alpha = result["alpha"].as<double>();
+    std::string save_dir = result["save_reference"].as<std::string>();
+    std::string reference_dir = result["reference_dir"].as<std::string>();
+    if (runs < 3) {
+        throw std::runtime_error("Equivalence tests need at least 3 runs per engine");
+    }
+
+    std::vector<Scenario> scenarios = reference_scenarios(result["n_epochs"].as<int>(), result["warmup"].as<int>());
+    std::vector<Scenario> ref_scenarios = scenarios;
+    for (auto & scenario : ref_scenarios) {
+        scenario.cfg.seed = seed;
+        scenario.cfg.arrival_sampler = result["reference_sampler"].as<std::string>();
+    }
+    std::string header = reference_header(ref_scenarios, runs);
+    if (!reference_dir.empty()) {check_reference_header(reference_dir, header);}
+    if (!save_dir.empty()) {
+        std::filesystem::create_directories(save_dir);
+        std::ofstream out(save_dir + "/reference.txt");
+        out << header;
+        if (!out) {throw std::runtime_error("Could not write " + save_dir + "/reference.txt");}
+    }
+
+    std::cout.setstate(std::ios::failbit);  // silence per-run chatter from the engine
+    auto t0 = std::chrono::high_resolution_clock::now();
+    std::vector<Comparison> comparisons;
+    for (int sc = 0; sc < scenarios.size(); sc++) {
+        const Scenario &scenario = scenarios[sc];
+        SimConfig ref_cfg = ref_scenarios[sc].cfg;
+        SimConfig cand_cfg = scenario.cfg;
+        cand_cfg.seed = seed + 1;
+        cand_cfg.arrival_sampler = result["candidate_sampler"].as<std::string>();
+
+        std::vector<RunStatistics> reference;
+        if (!reference_dir.empty()) {
+            for (int run = 0; run < runs; run++) {
+                reference.push_back(RunStatistics::load(reference_dir + "/" + scenario.name
+                                                        + "/stats_" + std::to_string(run) + ".txt"));
+            }
+        } else {
+            reference = simulate(ref_cfg, runs);
+        }
+        if (!save_dir.empty()) {
+            std::filesystem::create_directories(save_dir + "/" + scenario.name);
+            for (int run = 0; run < runs; run++) {
+                reference[run].save(save_dir + "/" + scenario.name + "/stats_" + std::to_string(run) + ".txt");
+            }
+        }
+        std::vector<RunStatistics> candidate = simulate(cand_cfg, runs);
+
+        int n_pathways = scenario.cfg.pathways.size();
+        for (int p = 0; p < n_pathways; p++) {
+            int first = comparisons.size();
+            for (int run = 0; run < runs; run++) {
+                auto ref_stats = run_statistics(pathway_or_empty(reference[run], p));
+                auto cand_stats = run_statistics(pathway_or_empty(candidate[run], p));
+                for (int s = 0; s < ref_stats.size(); s++) {
+                    if (run == 0) {comparisons.push_back({scenario.name, p, ref_stats[s].first, {}, {}});}
+                    comparisons[first + s].reference.push_back(ref_stats[s].second);
+                    comparisons[first + s].candidate.push_back(cand_stats[s].second);
+                }
+            }
+        }
+    }
+
+    // statistics undefined in some runs (e.g. quantiles with no discharges) are dropped
+    int n_tests = 0;
+    for (auto & c : comparisons) {
+        c.reference = finite(c.reference);
+        c.candidate = finite(c.candidate);
+        if (c.reference.size() >= 3 && c.candidate.size() >= 3) {n_tests += 2;}
+    }
+    double test_alpha = alpha / std::max(1, n_tests);
+
+    std::ofstream out(result["output"].as<std::string>());
+    if (!out) {throw std::runtime_error("Could not write " + result["output"].as<std::string>());}
+    out << "scenario,pathway,statistic,reference_mean,candidate_mean,ks_d,ks_p,diff_lower,diff_upper,test_alpha,pass\n";
+    int n_failed = 0;
+    for (auto & c : comparisons) {
+        if (c.reference.size() < 3 || c.candidate.size() < 3) {continue;}
+        std::pair<double, double> ks = ks_test(c.reference, c.candidate);
+        ConfidenceInterval diff = welch_ci(c.candidate, c.reference, 1 - test_alpha);
+        bool pass = ks.second >= test_alpha && diff.lower <= 0 && diff.upper >= 0;
+        out << c.scenario << "," << c.pathway << "," << c.statistic << ","
+            << stat_utils::mean(c.reference) << "," << stat_utils::mean(c.candidate) << ","
+            << ks.first << "," << ks.second << "," << diff.lower << "," << diff.upper << ","
+            << test_alpha << "," << pass << "\n";
+        if (!pass) {
+            n_failed += 1;
+            std::cerr << "Not equivalent: " << c.scenario << " pathway " << c.pathway << " " << c.statistic
+                        << " (reference " << stat_utils::mean(c.reference) << ", candidate "
+                        << stat_utils::mean(c.candidate) << ", KS p " << ks.second << ")" << std::endl;
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::cerr << n_tests << " tests at alpha " << test_alpha << " each, " << n_failed << " comparisons failed ("
+                << std::chrono::duration<double>(t1 - t0).count() << "s)" << std::endl;
+    return n_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,337 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+#include <stdexcept>
+#include <cxxopts.hpp>
+
+#include "RunStatistics.h"
+#include "WriteCSV.h"
+#include "SimConfig.h"
+#include "Replication.h"
+#include "CapacitySearch.h"
+#include "Splitting.h"
+#include "Federation.h"
+#include "DatasetWriter.h"
+#include "Shard.h"
+#include "ResultsCache.h"
+
+int main(int argc, char *argv[]){
+    // std::string folder = "/mnt/d/OneDrive - University of Waterloo/KidsAbility Research/Service Duration Analysis/C++ Simulations/";
+
+    // setup options parsing
+    cxxopts::Options options("Service Duration Simulation", "Simulate service duration for multi-class, multi-server queueing system.");
+    options.add_options()
+        ("n,n_epochs", "Number of epochs", cxxopts::value<int>()->default_value("10000"))
+        ("waitlist_prefill", "Number of clients to prefill onto the waitlist", cxxopts::value<int>()->default_value("0"))
+        ("c,servers", "Number of servers", cxxopts::value<int>()->default_value("80"))
+        ("n_group_servers", "Number of group servers for each pathway", 
+            cxxopts::value<std::vector<int>>()->default_value("0,0,0"))
+        ("group_size_props", "Proportion of group servers for each group size (1-4)",
+            cxxopts::value<std::vector<float>>()->default_value("0,0.33,0.33,0.33"))
+        ("group_size_effects", "Effect of group size on the number of appointments needed",
+            cxxopts::value<std::vector<float>>()->default_value("0,0,0,0"))
+        ("m,max_caseload", "Maximum caseload per servers", cxxopts::value<int>()->default_value("1"))
+        ("a,arr_lam", "Arrival rate lambda", cxxopts::value<double>()->default_value("10"))
+        ("f,folder", "Output folder", cxxopts::value<std::string>()->default_value("test/"))
+        ("p,pathways", "Class pathways", cxxopts::value<std::vector<int>>()->default_value("7,10,13"))
+        ("w,wait_effects", "Wait time effects", cxxopts::value<std::vector<double>>()->default_value("0.6,0.6,0.6"))
+        ("e,modality_effects", "Modality effects", cxxopts::value<std::vector<double>>()->default_value("0.5,0.0,-0.5"))
+        ("o,modality_policies", "Modality policies", cxxopts::value<std::vector<double>>()->default_value("0.5,0,1"))
+        ("x,max_ax_age", "Maximum age for ax", cxxopts::value<double>()->default_value("3.0"))
+        ("g,age_params", "Age parameters", cxxopts::value<std::vector<double>>()->default_value("1.5,1.0"))
+        ("priority_order", "Priority order of waitlist", cxxopts::value<std::vector<int>>()->default_value("0,1,2"))
+        ("priority_wlist", "Priority waitlist", cxxopts::value<bool>()->default_value("true"))
+        ("wl_policy", "Waitlist class selection (priority, random, lwf, age or fair; default from priority_wlist)",
+            cxxopts::value<std::string>()->default_value(""))
+        ("fair_weights", "Per-pathway weights for the fair policy (default equal)", cxxopts::value<std::vector<double>>())
+        ("arrival_probs", "Arrival probabilities", cxxopts::value<std::vector<double>>()->default_value("0.33,0.33,0.33"))
+        ("r,runs", "Number of runs", cxxopts::value<int>()->default_value("1"))
+        ("waitlist_log", "Log waitlist statistics", cxxopts::value<bool>()->default_value("false"))
+        ("virtual_att_probs", "Attendance probabilities for virtual appointments", cxxopts::value<std::vector<double>>()->default_value("0.9,0.025,0.025,0.05"))
+        ("face_att_probs", "Attendance probabilities for in person appointments", cxxopts::value<std::vector<double>>()->default_value("0.8,0.05,0.05,0.1"))
+        ("seed", "Global RNG seed (0 = random)", cxxopts::value<unsigned int>()->default_value("0"))
+        ("warmup", "Epochs excluded from summary statistics", cxxopts::value<int>()->default_value("0"))
+        ("capacity_search", "Search for the minimum number of servers meeting a target", cxxopts::value<bool>()->default_value("false"))
+        ("search_metric", "Search target metric (wait_quantile or age_out_rate)", cxxopts::value<std::string>()->default_value("wait_quantile"))
+        ("search_threshold", "Upper limit on the search metric for every pathway", cxxopts::value<double>()->default_value("26"))
+        ("search_quantile", "Wait time quantile used by wait_quantile", cxxopts::value<double>()->default_value("0.9"))
+        ("search_min_reps", "Minimum paired replications per candidate", cxxopts::value<int>()->default_value("3"))
+        ("search_max_reps", "Maximum paired replications per candidate", cxxopts::value<int>()->default_value("10"))
+        ("search_confidence", "Confidence level for feasibility decisions", cxxopts::value<double>()->default_value("0.95"))
+        ("search_utilization", "Utilization used to seed the search bracket", cxxopts::value<float>()->default_value("0.85"))
+        ("splitting", "Estimate the probability of a waitlist excursion by multilevel splitting", cxxopts::value<bool>()->default_value("false"))
+        ("split_pathway", "Pathway whose waitlist length is tracked", cxxopts::value<int>()->default_value("0"))
+        ("split_levels", "Increasing waitlist lengths; the last one is the critical threshold", cxxopts::value<std::vector<int>>()->default_value("100"))
+        ("split_horizon", "Epochs after the warm-up within which the threshold must be reached", cxxopts::value<int>()->default_value("52"))
+        ("split_effort", "Trajectories simulated per level", cxxopts::value<int>()->default_value("100"))
+        ("confidence", "Confidence level of across-run intervals (--splitting, --merge)", cxxopts::value<double>()->default_value("0.95"))
+        ("federation", "Simulate several sites in lockstep, one thread per site, with referrals between them", cxxopts::value<bool>()->default_value("false"))
+        ("sites", "Number of federated sites", cxxopts::value<int>()->default_value("2"))
+        ("site_servers", "Servers at each site (default --servers everywhere)", cxxopts::value<std::vector<int>>())
+        ("site_arr_lam", "Arrival rate at each site (default --arr_lam everywhere)", cxxopts::value<std::vector<double>>())
+        ("transfer_prob", "Probability that an arrival is referred to another site", cxxopts::value<double>()->default_value("0.1"))
+        ("arrival_sampler", "Arrival class/age sampler (alias or reference)", cxxopts::value<std::string>()->default_value("alias"))
+        ("arrival_trace", "Replay arrivals from a parquet trace (epoch, pathway, age[, base_duration])",
+            cxxopts::value<std::string>()->default_value(""))
+        ("compact_output", "Write discharges with the compact schema", cxxopts::value<bool>()->default_value("false"))
+        ("discharge_sample", "Write a weighted sample of this many discharges per pathway and outcome (0 = all)", cxxopts::value<int>()->default_value("0"))
+        ("scenario_id", "Scenario id recorded in compact output", cxxopts::value<int>()->default_value("0"))
+        ("output_layout", "Discharge output layout (flat or hive)", cxxopts::value<std::string>()->default_value("flat"))
+        ("runs_per_file", "Runs coalesced into each partition file (hive layout)", cxxopts::value<int>()->default_value("1"))
+        ("stability_check", "Stop runs early once the waitlist is diverging", cxxopts::value<bool>()->default_value("false"))
+        ("stability_window", "Epochs per stability test window", cxxopts::value<int>()->default_value("52"))
+        ("stability_min_windows", "Windows used by the stability test", cxxopts::value<int>()->default_value("6"))
+        ("stability_alpha", "Significance level of the waitlist trend test", cxxopts::value<double>()->default_value("0.01"))
+        ("appointment_log", "Log every appointment (patient id, epoch, modality, outcome)", cxxopts::value<bool>()->default_value("false"))
+        ("utilisation_log", "Log per-epoch slot use by server type, pathway and outcome", cxxopts::value<bool>()->default_value("false"))
+        ("shard", "Run only this shard's share of the runs, as i/N", cxxopts::value<std::string>()->default_value("0/1"))
+        ("merge", "Merge shard outputs into --folder instead of simulating", cxxopts::value<bool>()->default_value("false"))
+        ("merge_inputs", "Shard output folders to merge", cxxopts::value<std::vector<std::string>>()->default_value(""))
+        ("progress_interval", "Seconds between progress reports on stderr (0 = off)", cxxopts::value<double>()->default_value("0"))
+        ("status_file", "JSON status file rewritten with every progress report", cxxopts::value<std::string>()->default_value(""))
+        ("batch_means", "Batch-means confidence intervals from each run's steady state", cxxopts::value<bool>()->default_value("false"))
+        ("batch_count", "Batches kept per run (batch size doubles as the run grows)", cxxopts::value<int>()->default_value("32"))
+        ("batch_min", "Fewest batches allowed when growing batches against autocorrelation", cxxopts::value<int>()->default_value("10"))
+        ("batch_alpha", "Significance level of the lag-1 autocorrelation check", cxxopts::value<double>()->default_value("0.05"))
+        ("batch_confidence", "Confidence level of the batch-means intervals", cxxopts::value<double>()->default_value("0.95"))
+        ("cache_dir", "Reuse per-run results stored under this directory (empty = off)", cxxopts::value<std::string>()->default_value(""))
+        ("cache_outputs", "Also cache and restore the per-run output files (flat layout)", cxxopts::value<bool>()->default_value("false"))
+        ("cache_list", "List the entries of --cache_dir and exit", cxxopts::value<bool>()->default_value("false"))
+        ("cache_evict_mb", "Evict least recently used entries of --cache_dir down to this size and exit", cxxopts::value<double>())
+        ("cache_clear", "Remove every entry of --cache_dir and exit", cxxopts::value<bool>()->default_value("false"))
+        ("stability_tolerance", "Admission shortfall (fraction of arrivals) treated as over capacity", cxxopts::value<double>()->default_value("0.05"))
+    ;
+
+    auto result = options.parse(argc, argv);
+
+    SimConfig cfg;
+    cfg.n_epochs = result["n_epochs"].as<int>();
+    cfg.waitlist_prefill = result["waitlist_prefill"].as<int>();
+    cfg.n_servers = result["servers"].as<int>();
+    cfg.n_group_servers = result["n_group_servers"].as<std::vector<int>>();
+    cfg.group_size_props = result["group_size_props"].as<std::vector<float>>();
+    cfg.group_size_effects = result["group_size_effects"].as<std::vector<float>>();
+    cfg.max_caseload = result["max_caseload"].as<int>();
+    cfg.arr_lam = result["arr_lam"].as<double>();
+    cfg.probs = result["arrival_probs"].as<std::vector<double>>();
+    cfg.folder = result["folder"].as<std::string>();
+    cfg.pathways = result["pathways"].as<std::vector<int>>();
+    cfg.wait_effects = result["wait_effects"].as<std::vector<double>>();
+    cfg.modality_effects = result["modality_effects"].as<std::vector<double>>();
+    cfg.modality_policies = result["modality_policies"].as<std::vector<double>>();
+    cfg.max_ax_age = result["max_ax_age"].as<double>();
+    cfg.age_params = result["age_params"].as<std::vector<double>>();
+    cfg.p_order = result["priority_order"].as<std::vector<int>>();
+    cfg.priority_wlist = result["priority_wlist"].as<bool>();
+    cfg.wl_policy = result["wl_policy"].as<std::string>();
+    if (cfg.wl_policy.empty()) {cfg.wl_policy = cfg.priority_wlist ? "priority" : "random";}
+    // priority and random are the two priority_wlist modes, so the options must agree
+    if (cfg.wl_policy == "priority" || cfg.wl_policy == "random") {
+        bool priority = cfg.wl_policy == "priority";
+        if (result.count("priority_wlist") && cfg.priority_wlist != priority) {
+            throw std::runtime_error("--wl_policy " + cfg.wl_policy + " contradicts --priority_wlist");
+        }
+        cfg.priority_wlist = priority;
+    }
+    if (result.count("fair_weights")) {cfg.fair_weights = result["fair_weights"].as<std::vector<double>>();}
+    cfg.runs = result["runs"].as<int>();
+    cfg.waitlist_logging = result["waitlist_log"].as<bool>();
+    cfg.warmup = result["warmup"].as<int>();
+    cfg.arrival_sampler = result["arrival_sampler"].as<std::string>();
+    cfg.arrival_trace = result["arrival_trace"].as<std::string>();
+    cfg.compact_output = result["compact_output"].as<bool>();
+    cfg.discharge_sample = result["discharge_sample"].as<int>();
+    cfg.scenario_id = result["scenario_id"].as<int>();
+    cfg.output_layout = result["output_layout"].as<std::string>();
+    cfg.runs_per_file = result["runs_per_file"].as<int>();
+    cfg.appointment_log = result["appointment_log"].as<bool>();
+    cfg.utilisation_log = result["utilisation_log"].as<bool>();
+    cfg.stability_check = result["stability_check"].as<bool>();
+    cfg.stability_window = result["stability_window"].as<int>();
+    cfg.stability_min_windows = result["stability_min_windows"].as<int>();
+    cfg.stability_alpha = result["stability_alpha"].as<double>();
+    cfg.stability_tolerance = result["stability_tolerance"].as<double>();
+    cfg.batch_means = result["batch_means"].as<bool>();
+    cfg.batch_count = result["batch_count"].as<int>();
+    cfg.batch_min = result["batch_min"].as<int>();
+    cfg.batch_alpha = result["batch_alpha"].as<double>();
+    cfg.batch_confidence = result["batch_confidence"].as<double>();
+    cfg.progress_interval = result["progress_interval"].as<double>();
+    cfg.status_file = result["status_file"].as<std::string>();
+    ShardSpec shard = ShardSpec::parse(result["shard"].as<std::string>());
+    std::vector<double> virtual_att_probs = result["virtual_att_probs"].as<std::vector<double>>();
+    std::vector<double> face_att_probs = result["face_att_probs"].as<std::vector<double>>();
+
+    // set cancellation likelihoods
+    for (int i = 0; i < 4; i++) {
+        cfg.att_probs[0][i] = virtual_att_probs[i];
+    }
+    for (int i = 0; i < 4; i++) {
+        cfg.att_probs[1][i] = face_att_probs[i];
+    }
+
+    if (result["merge"].as<bool>()) {
+        merge_shards(result["merge_inputs"].as<std::vector<std::string>>(), cfg.folder,
+                    result["confidence"].as<double>());
+        return 0;
+    }
+
+    std::unique_ptr<ResultsCache> cache;
+    bool cache_outputs = result["cache_outputs"].as<bool>();
+    if (!result["cache_dir"].as<std::string>().empty()) {
+        cache = std::make_unique<ResultsCache>(result["cache_dir"].as<std::string>());
+    }
+    bool cache_command = result["cache_list"].as<bool>() || result["cache_clear"].as<bool>()
+                        || result.count("cache_evict_mb");
+    if (cache_command && !cache) {throw std::runtime_error("Cache commands need --cache_dir");}
+    if (result["cache_list"].as<bool>()) {cache->list(std::cout);}
+    if (result["cache_clear"].as<bool>()) {cache->clear();}
+    if (result.count("cache_evict_mb")) {cache->evict(result["cache_evict_mb"].as<double>());}
+    if (cache_command) {return 0;}
+    // a hit skips the run, and with it the run's rows of the shared hive dataset
+    if (cache && cfg.output_layout != "flat") {
+        throw std::runtime_error("--cache_dir needs the flat output layout");
+    }
+    if (cfg.discharge_sample > 0 && cfg.output_layout != "flat") {
+        throw std::runtime_error("--discharge_sample needs the flat output layout");
+    }
+
+    // seed 0 draws a fresh global seed; it is printed so the run can be reproduced
+    cfg.seed = result["seed"].as<unsigned int>();
+    if (cfg.seed == 0 && shard.is_sharded()) {
+        throw std::runtime_error("Sharded runs need an explicit --seed shared by all shards");
+    }
+    if (cfg.seed == 0) {
+        std::random_device rd;
+        cfg.seed = rd();
+    }
+    std::cout << "Seed: " << cfg.seed << std::endl;
+
+    if (result["capacity_search"].as<bool>()) {
+        CapacitySearch search = CapacitySearch(cfg, result["search_metric"].as<std::string>(),
+                                            result["search_threshold"].as<double>(),
+                                            result["search_quantile"].as<double>(),
+                                            result["search_min_reps"].as<int>(),
+                                            result["search_max_reps"].as<int>(),
+                                            result["search_confidence"].as<double>(),
+                                            result["search_utilization"].as<float>());
+        search.run();
+        search.write_results(cfg.folder + "capacity_search.csv");
+        return 0;
+    }
+
+    if (result["splitting"].as<bool>()) {
+        Splitting splitting = Splitting(cfg, result["split_pathway"].as<int>(),
+                                        result["split_levels"].as<std::vector<int>>(),
+                                        result["split_horizon"].as<int>(),
+                                        result["split_effort"].as<int>(),
+                                        result["confidence"].as<double>());
+        splitting.run();
+        splitting.write_results(cfg.folder + "splitting.csv");
+        return 0;
+    }
+
+    if (result["federation"].as<bool>()) {
+        if (cache) {throw std::runtime_error("--cache_dir is not available in federation mode");}
+        int n_sites = result["sites"].as<int>();
+        Federation federation = Federation(cfg, n_sites,
+                                        result.count("site_servers") ? result["site_servers"].as<std::vector<int>>() : std::vector<int>(),
+                                        result.count("site_arr_lam") ? result["site_arr_lam"].as<std::vector<double>>() : std::vector<double>(),
+                                        result["transfer_prob"].as<double>());
+        for (int run = 0; run < cfg.runs; run++) {
+            if (!shard.owns(cfg.scenario_id, run)) {continue;}
+            std::cout << "Run " << run << std::endl;
+            std::vector<RunStatistics> stats = federation.run(run, true);
+            for (int s = 0; s < n_sites; s++) {
+                std::string site_dir = cfg.folder + "site=" + std::to_string(s) + "/";
+                write_csv(site_dir + ("summary_" + std::to_string(run) + ".csv"), stats[s].summary());
+                stats[s].save(site_dir + ("stats_" + std::to_string(run) + ".txt"));
+            }
+            federation.write_results(cfg.folder + ("federation_" + std::to_string(run) + ".csv"));
+        }
+        return 0;
+    }
+
+    // create output paths
+    std::string path = cfg.folder;
+    std::string wl_path = cfg.folder + "waitlist_data/";
+    std::string summary_path = path;
+
+    // hive layout: one dataset shared by all runs, waitlist logs and summaries partitioned alongside
+    std::unique_ptr<DatasetWriter> dataset;
+    std::string scenario_dir = "scenario=" + std::to_string(cfg.scenario_id) + "/";
+    if (cfg.output_layout == "hive") {
+        dataset = std::make_unique<DatasetWriter>(path + "discharges/", cfg.scenario_id,
+                                                cfg.pathways.size(), cfg.runs_per_file, cfg.runs);
+        if (shard.is_sharded()) {dataset->set_part(shard.index);}
+        summary_path = path + "summary/" + scenario_dir;
+        std::filesystem::create_directories(summary_path);
+    } else if (cfg.output_layout != "flat") {
+        throw std::runtime_error("Unknown output layout: " + cfg.output_layout);
+    }
+
+    for (int run = 0; run < cfg.runs; run++){
+        if (!shard.owns(cfg.scenario_id, run, dataset ? cfg.runs_per_file : 1)) {continue;}
+        std::cout << "Run " << run << std::endl;
+        std::string run_path =  path + ("simulation_data_" + std::to_string(run) + ".parquet");
+        std::string waitlist_path = wl_path + ("waitlist_data_" + std::to_string(run) + ".parquet");
+        if (dataset) {
+            dataset->begin_run(run);
+            std::string run_dir = path + "waitlist/" + scenario_dir + "run=" + std::to_string(run) + "/";
+            if (cfg.waitlist_logging) {std::filesystem::create_directories(run_dir);}
+            waitlist_path = run_dir + "part-" + std::to_string(shard.index) + ".parquet";
+        }
+        std::string appointment_path = "";
+        if (cfg.appointment_log) {
+            std::string appt_dir = path + "appointments/";
+            if (dataset) {appt_dir += scenario_dir + "run=" + std::to_string(run) + "/";}
+            std::filesystem::create_directories(appt_dir);
+            appointment_path = appt_dir + (dataset ? "part-" + std::to_string(shard.index)
+                                                    : "appointments_" + std::to_string(run)) + ".parquet";
+        }
+        std::string utilisation_path = "";
+        if (cfg.utilisation_log) {
+            std::string util_dir = path + "utilisation/";
+            if (dataset) {util_dir += scenario_dir + "run=" + std::to_string(run) + "/";}
+            std::filesystem::create_directories(util_dir);
+            utilisation_path = util_dir + (dataset ? "part-" + std::to_string(shard.index)
+                                                    : "utilisation_" + std::to_string(run)) + ".parquet";
+        }
+        // a hit skips the simulation; with --cache_outputs the run's files must be cached too
+        std::string cache_key = cache ? ResultsCache::config_key(cfg, run) : "";
+        std::string variant = ResultsCache::output_variant(cfg);
+        RunStatistics stats;
+        // batch means are not part of the cached statistics
+        bool hit = cache && !cfg.batch_means && cache->lookup(cache_key, stats)
+                    && (!cache_outputs || cache->restore_outputs(cache_key, variant, path));
+        if (hit) {
+            std::cout << "Cached result for run " << run << std::endl;
+        } else {
+            stats = run_replication(cfg, run, run_path, waitlist_path, dataset.get(), appointment_path,
+                                    utilisation_path);
+            if (cache) {cache->store(cache_key, stats);}
+            if (cache && cache_outputs) {
+                std::vector<std::pair<std::string, std::string>> files;
+                files.push_back({run_path.substr(path.size()), run_path});
+                if (cfg.waitlist_logging) {files.push_back({waitlist_path.substr(path.size()), waitlist_path});}
+                if (cfg.appointment_log) {files.push_back({appointment_path.substr(path.size()), appointment_path});}
+                if (cfg.utilisation_log) {files.push_back({utilisation_path.substr(path.size()), utilisation_path});}
+                cache->store_outputs(cache_key, variant, files);
+            }
+        }
+        std::cout << "N admitted: " << stats.n_arrivals << " N discharged: " << stats.n_discharged << " N on waitlist: " << stats.n_waitlist << std::endl;
+        for (auto & row : stats.memory) {
+            std::cout << "  " << row.first << ": " << row.second << std::endl;
+        }
+        // per-run summary, also records the stability verdict of early-stopped runs
+        write_csv(summary_path + ("summary_" + std::to_string(run) + ".csv"), stats.summary());
+        stats.save(summary_path + ("stats_" + std::to_string(run) + ".txt"));     // for --merge
+        if (cfg.batch_means) {
+            BatchMeans::write_csv(summary_path + ("batch_means_" + std::to_string(run) + ".csv"), stats.batch_means);
+        }
+    }
+    if (dataset) {dataset->close();}
+};
\ No newline at end of file
@@ -0,0 +1,142 @@
+// simstats: summarises discharge outputs (flat simulation_data_<run>.parquet
+// files or a hive dataset) without loading them into Python.
+// Row groups are scanned in parallel and only the columns the statistics need
+// are decoded; per-run statistics are pooled exactly (RunStatistics) and
+// compared across runs with t-intervals.
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <cxxopts.hpp>
+#include "RunStatistics.h"
+#include "DischargeScanner.h"
+#include "StatUtils.h"
+
+namespace {
+    struct Statistic{
+        std::string name;
+        std::function<double(const PathwayStatistics&)> value;
+    };
+
+    const std::vector<Statistic> statistics = {
+        {"n_discharged", [](const PathwayStatistics &ps){return double(ps.n_discharged);}},
+        {"age_out_rate", [](const PathwayStatistics &ps){return ps.age_out_rate();}},
+        {"waitlist_age_out_rate", [](const PathwayStatistics &ps){
+            return ps.n_discharged == 0 ? std::nan("") : double(ps.n_waitlist_age_out) / ps.n_discharged;}},
+        {"wait_mean", [](const PathwayStatistics &ps){return ps.wait.mean();}},
+        {"wait_p50", [](const PathwayStatistics &ps){return ps.wait.quantile(0.5);}},
+        {"wait_p90", [](const PathwayStatistics &ps){return ps.wait.quantile(0.9);}},
+        {"wait_p95", [](const PathwayStatistics &ps){return ps.wait.quantile(0.95);}},
+        {"sojourn_mean", [](const PathwayStatistics &ps){return ps.sojourn.mean();}},
+        {"sojourn_p90", [](const PathwayStatistics &ps){return ps.sojourn.quantile(0.9);}},
+        {"n_appts_mean", [](const PathwayStatistics &ps){return ps.n_appts.mean();}},
+        {"pct_face_mean", [](const PathwayStatistics &ps){return ps.mean_pct_face();}},
+    };
+
+    // long format: one line per (scenario, pathway, statistic)
+    void write_summary(std::string path, const std::map<RunKey, RunStatistics> &stats, double confidence){
+        std::map<int, std::vector<const RunStatistics*>> by_scenario;
+        for (auto & kv : stats) {by_scenario[kv.first.first].push_back(&kv.second);}
+
+        std::ofstream out(path);
+        out << "scenario,pathway,statistic,pooled,run_mean,ci_lower,ci_upper,n_runs\n";
+        for (auto & kv : by_scenario) {
+            RunStatistics pooled;
+            for (auto run : kv.second) {pooled.merge(*run);}
+            for (int p = 0; p < pooled.n_pathways(); p++) {
+                for (auto & stat : statistics) {
+                    std::vector<double> xs;
+                    for (auto run : kv.second) {
+                        xs.push_back(p < run->n_pathways() ? stat.value(run->pathway(p)) : std::nan(""));
+                    }
+                    ConfidenceInterval ci = stat_utils::mean_ci(xs, confidence);
+                    out << kv.first << "," << p << "," << stat.name << ","
+                        << stat.value(pooled.pathway(p)) << "," << ci.mean << ","
+                        << ci.lower << "," << ci.upper << "," << ci.n << "\n";
+                }
+            }
+        }
+        out.close();
+    }
+}
+
+int main(int argc, char* argv[]){
+    cxxopts::Options options("simstats", "Summarise simulation discharge outputs");
+
+    options.add_options()
+        ("i,input", "Output folder, dataset root or single parquet file", cxxopts::value<std::string>()->default_value("test/"))
+        ("o,output", "Summary CSV (default: <input>/simstats.csv)", cxxopts::value<std::string>()->default_value(""))
+        ("threads", "Worker threads (0 = hardware concurrency)", cxxopts::value<int>()->default_value("0"))
+        ("warmup", "Exclude patients arriving before this epoch", cxxopts::value<int>()->default_value("0"))
+        ("confidence", "Confidence level of the across-run intervals", cxxopts::value<double>()->default_value("0.95"))
+    ;
+
+    auto result = options.parse(argc, argv);
+    std::string input = result["input"].as<std::string>();
+    std::string output = result["output"].as<std::string>();
+    if (output.empty()) {
+        output = std::filesystem::is_directory(input) ? input + "/simstats.csv" : input + ".simstats.csv";
+    }
+    int n_threads = result["threads"].as<int>();
+    if (n_threads <= 0) {n_threads = std::max(1u, std::thread::hardware_concurrency());}
+    int warmup = result["warmup"].as<int>();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<InputFile> files = find_discharge_inputs(input);
+    std::vector<ScanTask> tasks;
+    for (int f = 0; f < files.size(); f++) {
+        for (int g = 0; g < files[f].n_row_groups; g++) {tasks.push_back({f, g});}
+    }
+    std::cout << files.size() << " files, " << tasks.size() << " row groups, "
+                << n_threads << " threads" << std::endl;
+
+    // workers claim row groups in order and accumulate privately; merged once at the end
+    std::atomic<size_t> next_task(0);
+    std::mutex merge_mutex;
+    std::map<RunKey, RunStatistics> stats;
+    std::exception_ptr error;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < n_threads; t++) {
+        workers.emplace_back([&]() {
+            DischargeScanner scanner(files, warmup);
+            std::map<RunKey, RunStatistics> local;
+            try {
+                for (size_t i = next_task++; i < tasks.size(); i = next_task++) {
+                    scanner.scan(tasks[i], local);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(merge_mutex);
+                if (!error) {error = std::current_exception();}
+                next_task = tasks.size();
+                return;
+            }
+            std::lock_guard<std::mutex> lock(merge_mutex);
+            for (auto & kv : local) {
+                auto it = stats.find(kv.first);
+                if (it == stats.end()) {
+                    stats.emplace(kv.first, kv.second);
+                } else {
+                    it->second.merge(kv.second);
+                }
+            }
+        });
+    }
+    for (auto & w : workers) {w.join();}
+    if (error) {std::rethrow_exception(error);}
+
+    write_summary(output, stats, result["confidence"].as<double>());
+    auto stop = std::chrono::high_resolution_clock::now();
+    std::cout << stats.size() << " runs summarised to " << output << " in "
+                << std::chrono::duration<double>(stop - start).count() << "s." << std::endl;
+    return 0;
+}
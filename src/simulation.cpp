@@ -10,7 +10,6 @@
 
 #include "arrow/io/file.h"
 #include "parquet/stream_writer.h"
-#include <cxxopts.hpp>
 
 #include "Simulation.h"
 #include "Patient.h"
@@ -19,10 +18,19 @@
 #include "Server.h"
 #include "GroupServer.h"
 #include "Reader_Writer.h"
-#include "WriteCSV.h"
+#include "Invariants.h"
 
-std::random_device rd;
-std::mt19937 rng(rd());
+namespace {
+    // arrival ages are clamped to [min_arr_age, max_arr_age]; younger ages become young_arr_age
+    const double min_arr_age = 0.5;
+    const double max_arr_age = 2.5;
+    const double young_arr_age = 0.25;
+    const int n_age_bins = 1024;
+
+    double normal_cdf(double x, double mean, double sd){
+        return 0.5 * erfc(-(x - mean) / (sd * sqrt(2.0)));
+    }
+}
 
 Simulation::Simulation(int n_epochs, int n_servers,
                         std::vector<int> n_group_servers, std::vector<float> group_size_props,
@@ -50,9 +58,14 @@ Simulation::Simulation(int n_epochs, int n_servers,
         Simulation::set_n_classes(pathways.size());
         Simulation::set_class_dstb(std::discrete_distribution<> (probs.begin(), probs.end()));
         Simulation::set_age_dstb(std::normal_distribution<> (age_params[0], age_params[1]));
+        Simulation::set_age_table(age_params[0], age_params[1]);
         Simulation::set_att_probs(att_probs);
         Simulation::set_waitlist_logging(waitlist_logging);
 
+        // the waitlist only holds arrival records and builds patients on admission
+        wl.set_patient_factory(PatientFactory(wait_effects, modality_effects,
+                                            modality_policies, Simulation::att_probs));
+
         // setup output stream for waitlist statistics
         if (waitlist_logging) {
             std::cout << "Setting up waitlist output stream" << std::endl;
@@ -77,16 +90,59 @@ void Simulation::set_group_servers(std::vector<int> n){n_group_servers = n;}
 void Simulation::set_group_props(std::vector<float> p){group_size_props = p;}
 void Simulation::set_group_size_effects(std::vector<float> e){group_size_effects = e;}
 void Simulation::set_max_caseload(int m){max_caseload = m;}
-void Simulation::set_arr_lam(double l){arr_lam = l;}
+void Simulation::set_arr_lam(double l){
+    arr_lam = l;
+    arr_dstb = std::poisson_distribution<>(l);
+}
 void Simulation::set_pathways(std::vector<int> ps){pathways = ps;}
 void Simulation::set_wait_effects(std::vector<double> ws){wait_effects = ws;}
 void Simulation::set_modality_effects(std::vector<double> ms){modality_effects = ms;}
 void Simulation::set_modality_policies(std::vector<double> ps){modality_policies = ps;}
 void Simulation::set_probs(std::vector<double> ps){probs = ps;}
 void Simulation::set_n_classes(int n){n_classes = n;}
-void Simulation::set_class_dstb(std::discrete_distribution<> dstb){class_dstb = dstb;}
+void Simulation::set_class_dstb(std::discrete_distribution<> dstb){
+    class_dstb = dstb;
+    std::vector<double> ps = dstb.probabilities();
+    class_table = AliasTable(ps);
+}
 void Simulation::set_age_dstb(std::normal_distribution<> dstb){age_dstb = dstb;}
+void Simulation::set_alias_sampling(bool a){alias_sampling = a;}
+
+// discretises the clamped normal age distribution for get_alias_arr_age
+void Simulation::set_age_table(double mean, double sd){
+    double width = (max_arr_age - min_arr_age) / n_age_bins;
+    std::vector<double> weights(n_age_bins + 2);
+    weights[0] = normal_cdf(min_arr_age, mean, sd);
+    for (int k = 1; k <= n_age_bins; k++) {
+        double a = min_arr_age + (k - 1) * width;
+        weights[k] = normal_cdf(a + width, mean, sd) - normal_cdf(a, mean, sd);
+    }
+    weights[n_age_bins + 1] = 1 - normal_cdf(max_arr_age, mean, sd);
+    age_table = AliasTable(weights);
+}
 void Simulation::set_waitlist_logging(bool wl){waitlist_logging = wl;}
+void Simulation::set_rng(std::mt19937 gen){rng = gen;}
+void Simulation::set_stability_monitor(StabilityMonitor m){
+    monitor = m;
+    stability_check = true;
+}
+void Simulation::set_progress_reporter(ProgressReporter p){progress = p;}
+void Simulation::set_batch_means(BatchMeans *b){batch_means = b;}
+void Simulation::set_arrival_trace(std::shared_ptr<ArrivalTrace> t){trace = t;}
+void Simulation::set_arrival_router(std::function<bool(const WaitlistEntry&)> r){router = r;}
+
+// individual servers own one slot each, group servers one slot per seat
+void Simulation::set_utilisation_log(std::string path){
+    int group_slots = 0;
+    for (auto & server : group_servers) {group_slots += server.get_max_caseload();}
+    utilisation = std::make_unique<UtilisationLog>(path, n_classes, servers.size(), group_slots);
+    for (int i = 0; i < servers.size(); i++) {servers[i].set_utilisation_log(utilisation.get(), i);}
+    int slot = 0;
+    for (auto & server : group_servers) {
+        server.set_utilisation_log(utilisation.get(), slot);
+        slot += server.get_max_caseload();
+    }
+}
 void Simulation::set_att_probs(double p[2][4]){
     for (int i = 0; i < 2; i++){
         double sum = 0;
@@ -101,24 +157,54 @@ void Simulation::set_att_probs(double p[2][4]){
 double Simulation::get_arr_age(){
     double age = age_dstb(rng);
     // std::cout << "Age: " << age << std::endl;
-    if ((0.5 <= age) & (age <= 2.5)) {
+    if ((min_arr_age <= age) & (age <= max_arr_age)) {
         return age;
-    } else if (age < 0.5) {
-        return 0.25;
+    } else if (age < min_arr_age) {
+        return young_arr_age;
+    } else {
+        return max_arr_age;
+    }
+}
+
+// same distribution as get_arr_age, uniform within each fine bin
+double Simulation::get_alias_arr_age(){
+    int k = age_table.sample(rng);
+    if (k == 0) {
+        return young_arr_age;
+    } else if (k == n_age_bins + 1) {
+        return max_arr_age;
+    }
+    double width = (max_arr_age - min_arr_age) / n_age_bins;
+    return min_arr_age + (k - 1 + rng() * (1.0 / 4294967296.0)) * width;
+}
+
+WaitlistEntry Simulation::make_arrival(int epoch){
+    int pat_class;
+    double arr_age;
+    if (alias_sampling) {
+        pat_class = class_table.sample(rng);
+        arr_age = get_alias_arr_age();
     } else {
-        return 2.5;
+        pat_class = class_dstb(rng); // get int pat class
+        arr_age = get_arr_age();
     }
+    return WaitlistEntry{epoch, float(arr_age), (int16_t) pat_class,
+                        (int16_t) pathways[pat_class], epoch};
 }
 
 void Simulation::generate_servers() {
-    // generate individual servers
+    // generate individual servers, all of which start with open slots
     for (int i = 0; i < n_servers; i++) {
         servers.push_back(Server(max_caseload, wl, dl));
+        servers[i].set_next_free(i + 1 < n_servers ? i + 1 : -1);
     }
-    // generate group servers
+    free_head = n_servers > 0 ? 0 : -1;
+    // generate group servers, all of which start idle
+    idle_group_servers.resize(n_group_servers.size());
     for (int i = 0; i < n_group_servers.size(); i++) {
         for (int j = 0; j < group_size_props.size(); j++) {
             for (int k = 0; k < rint(n_group_servers[i] * group_size_props[j]); k++) {
+                idle_group_servers[i].insert(group_servers.size());
                 group_servers.push_back(GroupServer(i, pathways[i], j+1,
                                         group_size_effects[j],
                                         wl, dl));
@@ -127,60 +213,243 @@ void Simulation::generate_servers() {
     }
 }
 
+// one pass over the servers with open slots, each admits at most one patient
+// per epoch; skipped entirely while the waitlist is empty
+void Simulation::admit_patients(int epoch) {
+    int i = free_head;
+    while (i != -1 && !wl.is_empty()) {
+        servers[i].add_from_waitlist(epoch);
+        i = servers[i].get_next_free();
+    }
+}
+
+// fill idle group servers pathway by pathway, in server order; stops at the
+// first server that cannot be filled so an empty class is only checked once
+void Simulation::form_groups(int epoch) {
+    for (int p = 0; p < idle_group_servers.size(); p++) {
+        std::set<int> &idle = idle_group_servers[p];
+        auto it = idle.begin();
+        while (it != idle.end() && group_servers[*it].form_group(epoch)) {
+            it = idle.erase(it);
+        }
+    }
+}
+
+// draws the epoch's arrivals in one batch (or reads them from the trace)
+// and appends them to the waitlist
 void Simulation::generate_arrivals(int epoch) {
-    std::poisson_distribution<> arr_dstb(arr_lam);
+    arrival_batch.clear();
+    if (trace) {
+        n_admitted += trace->read_epoch(epoch, arrival_batch);
+        wl.add_entries(arrival_batch);
+        return;
+    }
     int n_patients = arr_dstb(rng);
     n_admitted += n_patients;
-    // std::cout << "Adding " << n_patients << " patients to waitlist." << std::endl;
     for (int i = 0; i < n_patients; i++) {
-        int pat_class = class_dstb(rng); // get int pat class
-        double arr_age = get_arr_age();
-        Patient pat = Patient(epoch, arr_age, pat_class, pathways[pat_class],
-                            wait_effects[pat_class], modality_effects[pat_class],
-                            modality_policies[pat_class], att_probs,
-                            rng);
-        wl.add_patient(pat, epoch);
-        // std::cout << "Waitlist length after adding patient: " << wl.len_waitlist() << std::endl;
+        arrival_batch.push_back(make_arrival(epoch));
     }
-    // std::cout << "successfuly generated arrivals" << std::endl;
+    if (router) {
+        int kept = 0;
+        for (int i = 0; i < arrival_batch.size(); i++) {
+            if (router(arrival_batch[i])) {
+                n_referred_out += 1;
+            } else {
+                arrival_batch[kept++] = arrival_batch[i];
+            }
+        }
+        arrival_batch.resize(kept);
+    }
+    wl.add_entries(arrival_batch);
+}
+
+// referrals keep their original arrival time, so waits count from first referral
+void Simulation::receive_referrals(int epoch, const std::vector<WaitlistEntry> &entries){
+    if (entries.empty()) {return;}
+    arrival_batch.clear();
+    for (auto entry : entries) {
+        entry.epoch = epoch;
+        arrival_batch.push_back(entry);
+    }
+    n_referred_in += entries.size();
+    wl.add_entries(arrival_batch);
 }
 
 void Simulation::prefill_waitlist(int n_patients) {
     // epoch is 0 -> could adjust to set a predefined wait time and make epoch negative
+    n_prefilled += n_patients;
+    arrival_batch.clear();
     for (int i = 0; i < n_patients; i++) {
-        int pat_class = class_dstb(rng);
-        double arr_age = get_arr_age();
-        Patient pat = Patient(0, arr_age, pat_class, pathways[pat_class],
-                            wait_effects[pat_class], modality_effects[pat_class],
-                            modality_policies[pat_class], att_probs,
-                            rng);
-        wl.add_patient(pat, 0);
+        arrival_batch.push_back(make_arrival(0));
     }
+    wl.add_entries(arrival_batch);
 }
 
 void Simulation::run() {
     auto start = std::chrono::high_resolution_clock::now();
+    if (memory_tracker::enabled()) {alloc_sampler.start();}
+    progress.start();
     for (int epoch = 0; epoch < n_epochs; epoch++) {
-        generate_arrivals(epoch);
-        for (int i = 0; i < servers.size(); i++) {
-            servers[i].process_epoch(epoch);
+        step(epoch);
+        if (memory_tracker::enabled()) {alloc_sampler.sample();}
+        if (progress.is_enabled()) {
+            progress.update(epochs_run, n_admitted, dl.get_n_patients(), wl.len_waitlist());
         }
-        for (int i = 0; i < group_servers.size(); i++) {
-            group_servers[i].process_epoch(epoch);
+        if (stability_check) {
+            monitor.record(wl.len_waitlist(), n_admitted, wl.get_n_admissions());
+            if (monitor.is_unstable()) {
+                std::cout << "Unstable run stopped at epoch " << epochs_run
+                            << " (admission deficit " << monitor.get_deficit()
+                            << ", trend z " << monitor.get_trend_z() << ")" << std::endl;
+                break;
+            }
         }
-        if (waitlist_logging){stream_waitlist(epoch);}
     }
+    progress.finish(epochs_run, n_admitted, dl.get_n_patients(), wl.len_waitlist());
     auto stop = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::seconds>(stop - start);
     std::cout << "Simulation duration: " << duration.count() << "s." << std::endl;
+    if (utilisation) {
+        double total = 0;
+        for (int s = 0; s < UtilisationLog::N_SLOT_STATES; s++) {total += utilisation->get_slots(s);}
+        if (total > 0) {
+            std::cout << "Slot use: attended " << utilisation->get_slots(ATTENDED) / total
+                        << ", no-show " << utilisation->get_slots(NO_SHOW) / total
+                        << ", late cancel " << utilisation->get_slots(LATE_CANCEL) / total
+                        << ", advance cancel " << utilisation->get_slots(ADVANCE_CANCEL) / total
+                        << ", unfilled " << utilisation->get_slots(UtilisationLog::UNFILLED) / total
+                        << ", idle " << utilisation->get_slots(UtilisationLog::IDLE) / total << std::endl;
+        }
+    }
+}
+
+// one epoch: arrivals, admissions, individual then group service
+void Simulation::step(int epoch) {
+    generate_arrivals(epoch);
+    admit_patients(epoch);
+    // process servers, relinking those with open slots in server order
+    int tail = -1;
+    free_head = -1;
+    for (int i = 0; i < servers.size(); i++) {
+        servers[i].process_epoch(epoch);
+        if (servers[i].has_capacity()) {
+            if (tail == -1) {
+                free_head = i;
+            } else {
+                servers[tail].set_next_free(i);
+            }
+            tail = i;
+        }
+    }
+    if (tail != -1) {servers[tail].set_next_free(-1);}
+    form_groups(epoch);
+    for (int i = 0; i < group_servers.size(); i++) {
+        if (group_servers[i].is_idle()) {continue;}
+        group_servers[i].process_epoch(epoch);
+        if (group_servers[i].is_idle()) {   // group finished -> back in the registry
+            idle_group_servers[group_servers[i].get_path()].insert(i);
+        }
+    }
+    if (waitlist_logging){stream_waitlist(epoch);}
+    if (batch_means) {record_batch_means(epoch);}
+    if (utilisation) {utilisation->end_epoch(epoch);}
+#ifdef SIM_CHECK_INVARIANTS
+    check_invariants(epoch);
+#endif
+    epochs_run = epoch + 1;
+}
+
+void Simulation::copy_state(const Simulation &other){
+    wl.copy_state(other.wl);
+    dl.copy_statistics(other.dl);
+    servers.clear();
+    for (auto & server : other.servers) {servers.push_back(Server(server, wl, dl));}
+    group_servers.clear();
+    for (auto & server : other.group_servers) {group_servers.push_back(GroupServer(server, wl, dl));}
+    idle_group_servers = other.idle_group_servers;
+    free_head = other.free_head;
+    n_admitted = other.n_admitted;
+    n_prefilled = other.n_prefilled;
+    n_referred_in = other.n_referred_in;
+    n_referred_out = other.n_referred_out;
+    epochs_run = other.epochs_run;
+    class_dstb = other.class_dstb;
+    age_dstb = other.age_dstb;
+    arr_dstb = other.arr_dstb;
+    rng = other.rng;
+}
+
+void Simulation::reseed(std::mt19937 &gen){
+    rng.seed(gen());
+    wl.rng.seed(gen());
+    age_dstb.reset();
+    arr_dstb.reset();
+    for (auto & server : servers) {server.reseed_patients(gen);}
+    for (auto & server : group_servers) {server.reseed_patients(gen);}
 }
 
 int Simulation::get_n_admitted(){return n_admitted;}
 
+long Simulation::get_n_referred_in(){return n_referred_in;}
+
+long Simulation::get_n_referred_out(){return n_referred_out;}
+
+bool Simulation::is_unstable(){return stability_check && monitor.is_unstable();}
+
+int Simulation::get_epochs_run(){return epochs_run;}
+
+const memory_tracker::EpochSampler& Simulation::get_alloc_sampler(){return alloc_sampler;}
+
 int Simulation::get_n_discharged(){return dl.get_n_patients();}
 
 int Simulation::get_n_waitlist(){return wl.len_waitlist();}
 
+void Simulation::record_batch_means(int epoch){
+    int busy_slots = 0;
+    for (auto & server : servers) {busy_slots += server.get_n_patients();}
+    int busy_groups = 0;
+    for (auto & server : group_servers) {busy_groups += !server.is_idle();}
+    batch_means->add_epoch(epoch, busy_slots, servers.size() * max_caseload,
+                        busy_groups, group_servers.size(), wl.len_waitlist());
+}
+
+int Simulation::get_n_in_service(){
+    int n = 0;
+    for (auto & server : servers) {n += server.get_n_patients();}
+    for (auto & server : group_servers) {n += server.get_n_patients();}
+    return n;
+}
+
+// every patient is in exactly one place, the free list is exactly the servers
+// with open slots (in order) and the idle registry holds exactly the idle groups
+void Simulation::check_invariants(int epoch){
+    wl.check_invariants();
+    for (auto & server : servers) {server.check_invariants();}
+    for (auto & server : group_servers) {server.check_invariants();}
+
+    long n_arrived = long(n_admitted) + n_prefilled + n_referred_in - n_referred_out;
+    long n_accounted = long(dl.get_n_patients()) + wl.len_waitlist() + get_n_in_service();
+    SIM_INVARIANT(n_arrived == n_accounted, "patients lost or duplicated at epoch " + std::to_string(epoch));
+    SIM_INVARIANT(wl.get_n_admissions() <= n_arrived, "more admissions than arrivals");
+
+    int prev = -1;
+    for (int i = free_head; i != -1; i = servers[i].get_next_free()) {
+        SIM_INVARIANT(i > prev && i < servers.size(), "free list out of order");
+        for (int j = prev + 1; j < i; j++) {
+            SIM_INVARIANT(!servers[j].has_capacity(), "server with capacity missing from the free list");
+        }
+        SIM_INVARIANT(servers[i].has_capacity(), "full server on the free list");
+        prev = i;
+    }
+    for (int j = prev + 1; j < servers.size(); j++) {
+        SIM_INVARIANT(!servers[j].has_capacity(), "server with capacity missing from the free list");
+    }
+    for (int g = 0; g < group_servers.size(); g++) {
+        bool registered = idle_group_servers[group_servers[g].get_path()].count(g) > 0;
+        SIM_INVARIANT(registered == group_servers[g].is_idle(), "idle group registry out of sync");
+    }
+}
+
 // not in use currently
 void Simulation::write_statistics(std::string path){}
 
@@ -221,117 +490,3 @@ void Simulation::write_parquet(std::string path) {
 void Simulation::stream_waitlist(int epoch){
     wl_os << epoch << wl.len_waitlist() << parquet::EndRow;
 }
-
-// functions for main
-int utilization_to_servers(float utilization, std::vector<int> pathways,
-                            std::vector<double> probs, double arr_lam){
-    float mu = 0;
-    for (int i = 0; i < pathways.size(); i++){
-        mu += probs[i] * arr_lam * pathways[i];
-    }
-    return ceil(mu/utilization);
-}
-
-int main(int argc, char *argv[]){
-    // std::string folder = "/mnt/d/OneDrive - University of Waterloo/KidsAbility Research/Service Duration Analysis/C++ Simulations/";
-
-    // setup options parsing
-    cxxopts::Options options("Service Duration Simulation", "Simulate service duration for multi-class, multi-server queueing system.");
-    options.add_options()
-        ("n,n_epochs", "Number of epochs", cxxopts::value<int>()->default_value("10000"))
-        ("waitlist_prefill", "Number of clients to prefill onto the waitlist", cxxopts::value<int>()->default_value("0"))
-        ("c,servers", "Number of servers", cxxopts::value<int>()->default_value("80"))
-        ("n_group_servers", "Number of group servers for each pathway", 
-            cxxopts::value<std::vector<int>>()->default_value("0,0,0"))
-        ("group_size_props", "Proportion of group servers for each group size (1-4)",
-            cxxopts::value<std::vector<float>>()->default_value("0,0.33,0.33,0.33"))
-        ("group_size_effects", "Effect of group size on the number of appointments needed",
-            cxxopts::value<std::vector<float>>()->default_value("0,0,0,0"))
-        ("m,max_caseload", "Maximum caseload per servers", cxxopts::value<int>()->default_value("1"))
-        ("a,arr_lam", "Arrival rate lambda", cxxopts::value<double>()->default_value("10"))
-        ("f,folder", "Output folder", cxxopts::value<std::string>()->default_value("test/"))
-        ("p,pathways", "Class pathways", cxxopts::value<std::vector<int>>()->default_value("7,10,13"))
-        ("w,wait_effects", "Wait time effects", cxxopts::value<std::vector<double>>()->default_value("0.6,0.6,0.6"))
-        ("e,modality_effects", "Modality effects", cxxopts::value<std::vector<double>>()->default_value("0.5,0.0,-0.5"))
-        ("o,modality_policies", "Modality policies", cxxopts::value<std::vector<double>>()->default_value("0.5,0,1"))
-        ("x,max_ax_age", "Maximum age for ax", cxxopts::value<double>()->default_value("3.0"))
-        ("g,age_params", "Age parameters", cxxopts::value<std::vector<double>>()->default_value("1.5,1.0"))
-        ("priority_order", "Priority order of waitlist", cxxopts::value<std::vector<int>>()->default_value("0,1,2"))
-        ("priority_wlist", "Priority waitlist", cxxopts::value<bool>()->default_value("true"))
-        ("arrival_probs", "Arrival probabilities", cxxopts::value<std::vector<double>>()->default_value("0.33,0.33,0.33"))
-        ("r,runs", "Number of runs", cxxopts::value<int>()->default_value("1"))
-        ("waitlist_log", "Log waitlist statistics", cxxopts::value<bool>()->default_value("false"))
-        ("virtual_att_probs", "Attendance probabilities for virtual appointments", cxxopts::value<std::vector<double>>()->default_value("0.9,0.025,0.025,0.05"))
-        ("face_att_probs", "Attendance probabilities for in person appointments", cxxopts::value<std::vector<double>>()->default_value("0.8,0.05,0.05,0.1"))
-    ;
-
-    auto result = options.parse(argc, argv);
-
-    int n_epochs = result["n_epochs"].as<int>();
-    int waitlist_prefill = result["waitlist_prefill"].as<int>();
-    int n_servers = result["servers"].as<int>();
-    std::vector<int> n_group_servers = result["n_group_servers"].as<std::vector<int>>();
-    std::vector<float> group_size_props = result["group_size_props"].as<std::vector<float>>();
-    std::vector<float> group_size_effects = result["group_size_effects"].as<std::vector<float>>();
-    int max_caseload = result["max_caseload"].as<int>();
-    double arr_lam = result["arr_lam"].as<double>();
-    std::vector<double> probs = result["arrival_probs"].as<std::vector<double>>();
-    // folder += result["folder"].as<std::string>();    // deprecated
-    std::string folder = result["folder"].as<std::string>();
-    std::vector<int> serv_path = result["pathways"].as<std::vector<int>>();
-    std::vector<double> wait_effects = result["wait_effects"].as<std::vector<double>>();
-    std::vector<double> modality_effects = result["modality_effects"].as<std::vector<double>>();
-    std::vector<double> modality_policies = result["modality_policies"].as<std::vector<double>>();
-    double max_ax_age = result["max_ax_age"].as<double>();
-    std::vector<double> age_params = result["age_params"].as<std::vector<double>>();
-    std::vector<int> p_order = result["priority_order"].as<std::vector<int>>();
-    bool priority_wlist = result["priority_wlist"].as<bool>();
-    int runs = result["runs"].as<int>();
-    bool waitlist_logging = result["waitlist_log"].as<bool>();
-    std::vector<double> virtual_att_probs = result["virtual_att_probs"].as<std::vector<double>>();
-    std::vector<double> face_att_probs = result["face_att_probs"].as<std::vector<double>>();
-
-    // set cancellation likelihoods
-    // double att_probs[2][4] = {
-    //     {0.9,0.025,0.025,0.05},
-    //     {0.8,0.05,0.05,0.10}
-    // };
-    double att_probs[2][4] = {0};
-    for (int i = 0; i < 4; i++) {
-        att_probs[0][i] = virtual_att_probs[i];
-    }
-    for (int i = 0; i < 4; i++) {
-        att_probs[1][i] = face_att_probs[i];
-    }
-
-    // create output paths
-    std::string path = folder;
-    std::string wl_path = folder + "waitlist_data/";
-
-    for (int run = 0; run < runs; run++){
-        std::cout << "Run " << run << std::endl;
-        std::string run_path =  path + ("simulation_data_" + std::to_string(run) + ".parquet");
-        std::string waitlist_path = wl_path + ("waitlist_data_" + std::to_string(run) + ".parquet");
-        // initialize waitlist and discharge list instances
-        DischargeList dl = DischargeList(run_path);
-        Waitlist wl = Waitlist(serv_path.size(), max_ax_age,
-                                priority_wlist, p_order,
-                                rng, dl);
-        Simulation sim = Simulation(n_epochs, n_servers,
-                                    n_group_servers,
-                                    group_size_props,
-                                    group_size_effects,
-                                    max_caseload, arr_lam,
-                                    serv_path, wait_effects, 
-                                    modality_effects, modality_policies,
-                                    att_probs,
-                                    probs, age_params, 
-                                    max_ax_age, waitlist_path,
-                                    waitlist_logging,
-                                    dl, wl);
-        sim.generate_servers();
-        sim.prefill_waitlist(waitlist_prefill); // prefill the waitlist
-        sim.run();
-        std::cout << "N admitted: " << sim.get_n_admitted() << " N discharged: " << sim.get_n_discharged() << " N on waitlist: " << sim.get_n_waitlist() << std::endl;
-    }
-};
\ No newline at end of file
@@ -0,0 +1,143 @@
+// stress: runs many short, randomly configured simulations with invariant
+// checks compiled in (SIM_CHECK_INVARIANTS). Each configuration is drawn from
+// (--seed, iteration), so a failure is reproduced with --seed S --start I
+// --iterations 1. Exits non-zero on the first failure.
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <cxxopts.hpp>
+
+#include "SimConfig.h"
+#include "Replication.h"
+#include "RunStatistics.h"
+#include "Invariants.h"
+
+namespace {
+    std::vector<double> random_probs(int n, std::mt19937 &gen){
+        std::uniform_real_distribution<double> u(0.05, 1.0);
+        std::vector<double> probs(n);
+        for (auto & p : probs) {p = u(gen);}
+        double total = std::accumulate(probs.begin(), probs.end(), 0.0);
+        for (auto & p : probs) {p /= total;}
+        return probs;
+    }
+
+    SimConfig random_config(std::mt19937 &gen, int max_epochs){
+        auto uniform_int = [&](int lo, int hi){return std::uniform_int_distribution<int>(lo, hi)(gen);};
+        auto uniform = [&](double lo, double hi){return std::uniform_real_distribution<double>(lo, hi)(gen);};
+        auto coin = [&](double p){return std::bernoulli_distribution(p)(gen);};
+
+        SimConfig cfg;
+        int n_classes = uniform_int(1, 6);
+        cfg.n_epochs = uniform_int(1, max_epochs);
+        cfg.waitlist_prefill = coin(0.3) ? uniform_int(0, 300) : 0;
+        cfg.n_servers = uniform_int(0, 60);
+        cfg.max_caseload = uniform_int(1, 4);
+        cfg.arr_lam = uniform(0.1, 20);
+        cfg.probs = random_probs(n_classes, gen);
+        cfg.pathways.clear();
+        cfg.wait_effects.clear();
+        cfg.modality_effects.clear();
+        cfg.modality_policies.clear();
+        cfg.n_group_servers.clear();
+        for (int c = 0; c < n_classes; c++) {
+            cfg.pathways.push_back(uniform_int(1, 20));
+            cfg.wait_effects.push_back(uniform(0, 1.5));
+            cfg.modality_effects.push_back(uniform(-1, 1));
+            cfg.modality_policies.push_back(uniform(0, 1));
+            cfg.n_group_servers.push_back(coin(0.3) ? uniform_int(0, 6) : 0);
+        }
+        cfg.group_size_props = {0, 0, 0, 0};
+        for (int j = 1; j < 4; j++) {cfg.group_size_props[j] = float(uniform(0, 1));}
+        cfg.group_size_effects = {0, float(uniform(-0.3, 0.3)), float(uniform(-0.3, 0.3)), float(uniform(-0.3, 0.3))};
+        cfg.max_ax_age = uniform(1.0, 5.0);
+        cfg.age_params = {uniform(0.5, 3.0), uniform(0.1, 1.5)};
+        cfg.p_order.resize(n_classes);
+        std::iota(cfg.p_order.begin(), cfg.p_order.end(), 0);
+        std::shuffle(cfg.p_order.begin(), cfg.p_order.end(), gen);
+        cfg.priority_wlist = coin(0.5);
+        for (int m = 0; m < 2; m++) {
+            std::vector<double> att = random_probs(4, gen);
+            for (int j = 0; j < 4; j++) {cfg.att_probs[m][j] = att[j];}
+        }
+        cfg.seed = gen();
+        cfg.warmup = coin(0.3) ? uniform_int(0, cfg.n_epochs) : 0;
+        cfg.arrival_sampler = coin(0.5) ? "alias" : "reference";
+        cfg.stability_check = coin(0.3);
+        cfg.stability_window = uniform_int(2, 20);
+        cfg.stability_min_windows = uniform_int(3, 6);
+        const char *policies[] = {"priority", "random", "lwf", "age", "fair"};
+        cfg.wl_policy = policies[uniform_int(0, 4)];
+        if (cfg.wl_policy == "priority" || cfg.wl_policy == "random") {    // Waitlist requires them to agree
+            cfg.priority_wlist = cfg.wl_policy == "priority";
+        }
+        cfg.fair_weights.clear();
+        for (int c = 0; c < n_classes; c++) {cfg.fair_weights.push_back(uniform(0.1, 3));}
+        return cfg;
+    }
+
+    // end-of-run consistency on top of the per-epoch checks
+    void check_statistics(const SimConfig &cfg, const RunStatistics &stats){
+        long n_discharged = 0;
+        for (int p = 0; p < stats.n_pathways(); p++) {
+            const PathwayStatistics &ps = stats.pathway(p);
+            if (ps.n_discharged != ps.n_completed + ps.n_aged_out || ps.n_waitlist_age_out > ps.n_aged_out
+                || ps.wait.n != ps.n_discharged || ps.sojourn.n != ps.n_discharged) {
+                throw std::logic_error("Pathway " + std::to_string(p) + " statistics inconsistent");
+            }
+            n_discharged += ps.n_discharged;
+        }
+        if (cfg.warmup == 0 && n_discharged != stats.n_discharged) {
+            throw std::logic_error("Pathway discharges do not sum to the run total");
+        }
+        if (stats.epochs_run > cfg.n_epochs || (stats.stable && stats.epochs_run != cfg.n_epochs)) {
+            throw std::logic_error("Run length inconsistent with its stability verdict");
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    cxxopts::Options options("stress", "Randomized simulation runs with invariant checking");
+    options.add_options()
+        ("iterations", "Number of random configurations", cxxopts::value<int>()->default_value("1000"))
+        ("start", "First iteration index", cxxopts::value<int>()->default_value("0"))
+        ("seed", "Seed for the configuration generator", cxxopts::value<unsigned int>()->default_value("1"))
+        ("max_epochs", "Upper bound on epochs per run", cxxopts::value<int>()->default_value("300"))
+    ;
+    auto result = options.parse(argc, argv);
+    int iterations = result["iterations"].as<int>();
+    int start = result["start"].as<int>();
+    unsigned int seed = result["seed"].as<unsigned int>();
+    int max_epochs = result["max_epochs"].as<int>();
+
+    if (!invariants::enabled()) {
+        std::cerr << "Warning: built without SIM_CHECK_INVARIANTS, only end-of-run checks apply" << std::endl;
+    }
+    std::cout.setstate(std::ios::failbit);  // silence per-run chatter from the engine
+    auto t0 = std::chrono::high_resolution_clock::now();
+    long epochs = 0;
+    for (int it = start; it < start + iterations; it++) {
+        std::seed_seq seq{seed, (unsigned int) it};
+        std::mt19937 gen(seq);
+        SimConfig cfg = random_config(gen, max_epochs);
+        try {
+            RunStatistics stats = run_replication(cfg, it);
+            check_statistics(cfg, stats);
+            epochs += stats.epochs_run;
+        } catch (const std::exception &e) {
+            std::cerr << "Iteration " << it << " failed: " << e.what() << std::endl;
+            std::cerr << "Reproduce with: stress --seed " << seed << " --start " << it
+                        << " --iterations 1" << std::endl;
+            return 1;
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::cerr << iterations << " configurations passed (" << epochs << " epochs, "
+                << std::chrono::duration<double>(t1 - t0).count() << "s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,176 @@
+// simstats_test: checks that DischargeScanner (the reading side of simstats)
+// reproduces the RunStatistics of the rows it reads.
+//   - multi_page: a file written with tiny data pages, so every column's pages
+//     end on different rows
+//   - engine: outputs of run_replication, in both discharge schemas, against
+//     the statistics the engine accumulated itself; the appointment and
+//     utilisation logs written alongside must not be read as discharges
+// Exits non-zero on the first mismatch.
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+
+#include "arrow/io/file.h"
+#include "parquet/api/reader.h"
+#include "parquet/stream_writer.h"
+#include "Reader_Writer.h"
+#include "SimConfig.h"
+#include "Replication.h"
+#include "RunStatistics.h"
+#include "DischargeScanner.h"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    void check(bool condition, const std::string &what){
+        if (!condition) {throw std::logic_error(what);}
+    }
+
+    std::string histogram_text(const Histogram &h){
+        std::ostringstream out;
+        h.write(out);
+        return out.str();
+    }
+
+    void check_equal(const RunStatistics &expected, const RunStatistics &actual, const std::string &label){
+        check(expected.n_pathways() == actual.n_pathways(), label + ": pathway count differs");
+        for (int p = 0; p < expected.n_pathways(); p++) {
+            const PathwayStatistics &e = expected.pathway(p);
+            const PathwayStatistics &a = actual.pathway(p);
+            std::string where = label + " pathway " + std::to_string(p) + ": ";
+            check(e.n_discharged == a.n_discharged, where + "n_discharged differs");
+            check(e.n_completed == a.n_completed, where + "n_completed differs");
+            check(e.n_aged_out == a.n_aged_out, where + "n_aged_out differs");
+            check(e.n_waitlist_age_out == a.n_waitlist_age_out, where + "n_waitlist_age_out differs");
+            check(e.n_treated == a.n_treated, where + "n_treated differs");
+            check(std::fabs(e.sum_pct_face - a.sum_pct_face) <= 1e-6 * std::max(1.0, e.sum_pct_face),
+                where + "sum_pct_face differs");
+            check(histogram_text(e.wait) == histogram_text(a.wait), where + "wait histogram differs");
+            check(histogram_text(e.sojourn) == histogram_text(a.sojourn), where + "sojourn histogram differs");
+            check(histogram_text(e.n_appts) == histogram_text(a.n_appts), where + "n_appts histogram differs");
+        }
+    }
+
+    std::map<RunKey, RunStatistics> scan(std::string input, int warmup){
+        std::vector<InputFile> files = find_discharge_inputs(input);
+        DischargeScanner scanner(files, warmup);
+        std::map<RunKey, RunStatistics> stats;
+        for (int f = 0; f < files.size(); f++) {
+            for (int g = 0; g < files[f].n_row_groups; g++) {scanner.scan({f, g}, stats);}
+        }
+        return stats;
+    }
+
+    int count_data_pages(std::string path, std::string column){
+        std::unique_ptr<parquet::ParquetFileReader> reader = parquet::ParquetFileReader::OpenFile(path, false);
+        int idx = reader->metadata()->schema()->ColumnIndex(column);
+        std::unique_ptr<parquet::PageReader> pages = reader->RowGroup(0)->GetColumnPageReader(idx);
+        int n = 0;
+        while (std::shared_ptr<parquet::Page> page = pages->NextPage()) {
+            if (page->type() != parquet::PageType::DICTIONARY_PAGE) {n += 1;}
+        }
+        return n;
+    }
+
+    // random discharge rows in the full schema, with 256-byte data pages
+    void multi_page(fs::path dir){
+        fs::create_directories(dir);
+        std::string path = (dir / "simulation_data_0.parquet").string();
+        const int n_rows = 50000;
+        const int warmup = 100;
+        RunStatistics expected(warmup);
+        {
+            std::shared_ptr<arrow::io::FileOutputStream> outfile;
+            PARQUET_ASSIGN_OR_THROW(outfile, arrow::io::FileOutputStream::Open(path));
+            parquet::WriterProperties::Builder builder;
+            builder.data_pagesize(256)
+                ->write_batch_size(16)
+                ->disable_dictionary("arrival_t")
+                ->disable_dictionary("discharge_t");
+            parquet::StreamWriter os(parquet::ParquetFileWriter::Open(outfile, SetupSchema(), builder.build()));
+
+            std::mt19937 gen(7);
+            auto uniform_int = [&](int lo, int hi){return std::uniform_int_distribution<int>(lo, hi)(gen);};
+            for (int i = 0; i < n_rows; i++) {
+                int pathway = uniform_int(0, 2);
+                int arrival_t = uniform_int(0, 5000);
+                bool waitlist_age_out = uniform_int(0, 9) == 0;
+                int n_appts = waitlist_age_out ? 0 : uniform_int(1, 20);
+                int first_appt = waitlist_age_out ? -1 : arrival_t + uniform_int(0, 300);
+                int discharge_t = waitlist_age_out ? arrival_t + uniform_int(1, 200) : first_appt + n_appts;
+                int wait = waitlist_age_out ? 0 : first_appt - arrival_t;
+                int modality_sum = uniform_int(0, n_appts);
+                int age_out = waitlist_age_out || uniform_int(0, 19) == 0;
+                float pct_face = n_appts == 0 ? 0.0f : float(modality_sum) / float(n_appts);
+                os << pathway << uniform_int(7, 13) << arrival_t << float(uniform_int(0, 30)) / 10
+                    << first_appt << n_appts << discharge_t << 0 << (discharge_t - arrival_t) << wait
+                    << n_appts << modality_sum << pct_face << age_out << 0.0f << parquet::EndRow;
+                if (waitlist_age_out) {
+                    expected.add_discharge(pathway, arrival_t, discharge_t - arrival_t, discharge_t - arrival_t,
+                                        0, 0, true, true);
+                } else {
+                    expected.add_discharge(pathway, arrival_t, wait, discharge_t - arrival_t, n_appts,
+                                        modality_sum, age_out == 1, false);
+                }
+            }
+        }
+        int class_pages = count_data_pages(path, "class");
+        int arrival_pages = count_data_pages(path, "arrival_t");
+        check(arrival_pages > 1 && arrival_pages != class_pages, "multi_page: page boundaries do not differ");
+
+        std::map<RunKey, RunStatistics> stats = scan(path, warmup);
+        check(stats.size() == 1 && stats.count({0, 0}), "multi_page: expected a single run");
+        check_equal(expected, stats[{0, 0}], "multi_page");
+        std::cerr << "multi_page: " << n_rows << " rows, " << arrival_pages << " arrival_t and "
+                    << class_pages << " class pages" << std::endl;
+    }
+
+    // congested enough for waitlist and in-service age-outs
+    void engine(fs::path dir, bool compact){
+        SimConfig cfg;
+        cfg.n_epochs = 800;
+        cfg.warmup = 100;
+        cfg.n_servers = 70;
+        cfg.seed = 11;
+        cfg.compact_output = compact;
+        std::string label = compact ? "engine_compact" : "engine";
+        fs::path run_dir = dir / label;
+        fs::create_directories(run_dir / "appointments");
+        fs::create_directories(run_dir / "utilisation");
+        RunStatistics expected = run_replication(cfg, 0, (run_dir / "simulation_data_0.parquet").string(), "",
+                                                nullptr, (run_dir / "appointments/appointments_0.parquet").string(),
+                                                (run_dir / "utilisation/utilisation_0.parquet").string());
+
+        check(find_discharge_inputs(run_dir.string()).size() == 1, label + ": logs taken for discharge files");
+        std::map<RunKey, RunStatistics> stats = scan(run_dir.string(), cfg.warmup);
+        check(stats.size() == 1 && stats.count({0, 0}), label + ": expected a single run");
+        check_equal(expected, stats[{0, 0}], label);
+        long waitlist_age_outs = 0;
+        for (int p = 0; p < expected.n_pathways(); p++) {waitlist_age_outs += expected.pathway(p).n_waitlist_age_out;}
+        check(waitlist_age_outs > 0, label + ": scenario produced no waitlist age-outs");
+        std::cerr << label << ": matches RunStatistics (" << waitlist_age_outs << " waitlist age-outs)" << std::endl;
+    }
+}
+
+int main(){
+    fs::path dir = fs::temp_directory_path() / "simstats_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::cout.setstate(std::ios::failbit);  // silence per-run chatter from the engine
+    try {
+        multi_page(dir / "multi_page");
+        engine(dir, false);
+        engine(dir, true);
+    } catch (const std::exception &e) {
+        std::cerr << "simstats_test failed: " << e.what() << std::endl;
+        return 1;
+    }
+    fs::remove_all(dir);
+    return 0;
+}